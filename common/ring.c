@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Ordered processing of chunks by a pool of threads.
+ *
+ * The thread running ringExecute reads chunks into a bounded ring of slots,
+ * workers transform the slots concurrently and the same thread writes them
+ * back strictly in the order they were read. A slot is reused only after it
+ * has been written, so at most two chunks per worker are held in memory
+ * whatever the size of the input. What a chunk is and how it is transformed
+ * is left to the callbacks of the ring.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ring.h"
+
+/// Count of slots per worker thread, one being transformed and one waiting
+#define SLOTS_PER_THREAD 2
+
+/**
+ * State shared by the reading thread and workers
+ */
+typedef struct {
+    /// Callbacks of the ring
+    const ring_t *ring;
+    /// Memory of all slots
+    char *slots;
+    /// Status of the transformation of every slot
+    int *statuses;
+    /// Has the slot been transformed?
+    bool *transformed;
+    /// Count of slots
+    size_t count;
+    /// Sequence number of the oldest slot not written yet
+    size_t head;
+    /// Sequence number of the oldest slot not taken by a worker
+    size_t next;
+    /// Sequence number of the next slot to read
+    size_t tail;
+    /// Has the whole input been read?
+    bool finished;
+    /// Lock of the sequence numbers, statuses and flags
+    pthread_mutex_t lock;
+    /// Signals a read slot for workers
+    pthread_cond_t work;
+    /// Signals a transformed slot for the reading thread
+    pthread_cond_t done;
+} shared_t;
+
+/**
+ * One worker thread
+ */
+typedef struct {
+    /// Shared state
+    shared_t *shared;
+    /// Local state, NULL if workers have none
+    void *local;
+    /// Thread handle
+    pthread_t thread;
+} worker_t;
+
+/**
+ * Gets the slot with the sequence number
+ * @param shared Shared state
+ * @param sequence Sequence number
+ * @return Slot
+ */
+static void *slotAt(const shared_t *shared, size_t sequence) {
+    return shared->slots + (sequence % shared->count) * shared->ring->slotSize;
+}
+
+/**
+ * Worker thread, transforms slots until the whole input is processed
+ * @param argument Worker
+ * @return Nothing
+ */
+static void *work(void *argument) {
+    worker_t *worker = argument;
+    shared_t *shared = worker->shared;
+    const ring_t *ring = shared->ring;
+    int opened = (ring->open != NULL) ? ring->open(ring->argument, worker->local) : 0;
+    pthread_mutex_lock(&shared->lock);
+    for (;;) {
+        while (shared->next == shared->tail && !shared->finished) {
+            pthread_cond_wait(&shared->work, &shared->lock);
+        }
+        if (shared->next == shared->tail) {
+            break;
+        }
+        size_t sequence = shared->next++;
+        pthread_mutex_unlock(&shared->lock);
+        int status = opened;
+        if (status == 0) {
+            status = ring->transform(ring->argument, worker->local, slotAt(shared, sequence));
+        }
+        pthread_mutex_lock(&shared->lock);
+        shared->statuses[sequence % shared->count] = status;
+        shared->transformed[sequence % shared->count] = true;
+        pthread_cond_signal(&shared->done);
+    }
+    pthread_mutex_unlock(&shared->lock);
+    if (opened == 0 && ring->close != NULL) {
+        ring->close(worker->local);
+    }
+    return NULL;
+}
+
+/**
+ * Gets the default count of worker threads
+ * @return Count of online processors, at most RING_MAX_THREADS
+ */
+unsigned int ringThreads(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    if (online > RING_MAX_THREADS) {
+        return RING_MAX_THREADS;
+    }
+    return (online > 0) ? (unsigned int) online : 1;
+}
+
+/**
+ * Reads, transforms and writes all chunks of the input
+ * If only some workers can be started, the ring runs with them and says so
+ * on stderr.
+ * @param ring Callbacks of the ring
+ * @param threads Count of worker threads, 0 for the count of processors, at most RING_MAX_THREADS are started
+ * @return 0 on success, otherwise the first failed status in the order of reading or an error status of the ring
+ */
+int ringExecute(const ring_t *ring, unsigned int threads) {
+    if (threads == 0) {
+        threads = ringThreads();
+    }
+    if (threads > RING_MAX_THREADS) {
+        threads = RING_MAX_THREADS;
+    }
+    shared_t shared = {ring, NULL, NULL, NULL, SLOTS_PER_THREAD * threads, 0, 0, 0, false,
+                       PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER};
+    shared.slots = calloc(shared.count, ring->slotSize);
+    shared.statuses = calloc(shared.count, sizeof(int));
+    shared.transformed = calloc(shared.count, sizeof(bool));
+    worker_t *workers = calloc(threads, sizeof(worker_t));
+    char *locals = (ring->localSize > 0) ? calloc(threads, ring->localSize) : NULL;
+    if (shared.slots == NULL || shared.statuses == NULL || shared.transformed == NULL || workers == NULL ||
+        (ring->localSize > 0 && locals == NULL)) {
+        free(shared.slots);
+        free(shared.statuses);
+        free(shared.transformed);
+        free(workers);
+        free(locals);
+        return ring->allocationError;
+    }
+    unsigned int started = 0;
+    int error = 0;
+    for (; started < threads; started++) {
+        workers[started].shared = &shared;
+        workers[started].local = (locals != NULL) ? locals + started * ring->localSize : NULL;
+        if ((error = pthread_create(&workers[started].thread, NULL, work, &workers[started])) != 0) {
+            break;
+        }
+    }
+    int status = 0;
+    if (started == 0) {
+        fprintf(stderr, "Cannot start a worker thread: %s.\n", strerror(error));
+        status = ring->threadError;
+    } else if (started < threads) {
+        fprintf(stderr, "Started only %u of %u worker threads: %s.\n", started, threads, strerror(error));
+    }
+    bool end = false;
+    pthread_mutex_lock(&shared.lock);
+    while (status == 0) {
+        if (shared.head != shared.tail && shared.transformed[shared.head % shared.count]) {
+            // Workers do not touch the slot until the reading thread refills it
+            pthread_mutex_unlock(&shared.lock);
+            status = shared.statuses[shared.head % shared.count];
+            if (status == 0) {
+                status = ring->write(ring->argument, slotAt(&shared, shared.head));
+            }
+            shared.transformed[shared.head % shared.count] = false;
+            pthread_mutex_lock(&shared.lock);
+            shared.head++;
+        } else if (!end && shared.tail - shared.head < shared.count) {
+            pthread_mutex_unlock(&shared.lock);
+            status = ring->read(ring->argument, slotAt(&shared, shared.tail), &end);
+            pthread_mutex_lock(&shared.lock);
+            if (status == 0 && !end) {
+                shared.tail++;
+                pthread_cond_signal(&shared.work);
+            }
+        } else if (end && shared.head == shared.tail) {
+            break;
+        } else {
+            pthread_cond_wait(&shared.done, &shared.lock);
+        }
+    }
+    shared.finished = true;
+    pthread_cond_broadcast(&shared.work);
+    pthread_mutex_unlock(&shared.lock);
+    for (unsigned int i = 0; i < started; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    if (ring->release != NULL) {
+        for (size_t i = 0; i < shared.count; i++) {
+            ring->release(shared.slots + i * ring->slotSize);
+        }
+    }
+    free(shared.slots);
+    free(shared.statuses);
+    free(shared.transformed);
+    free(workers);
+    free(locals);
+    return status;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Maximal count of worker threads of the ring
+#define RING_MAX_THREADS 256
+
+/**
+ * Fills the slot with the next chunk of the input, called by the thread running ringExecute
+ * @param argument Argument of the ring
+ * @param slot Slot to fill, keeps whatever the previous chunk left in it
+ * @param end Set when there is no other chunk, the slot is then ignored
+ * @return 0 on success, anything else stops the ring and is returned by ringExecute
+ */
+typedef int (*ringRead_t)(void *argument, void *slot, bool *end);
+
+/**
+ * Transforms the chunk in the slot, called by workers concurrently
+ * @param argument Argument of the ring
+ * @param local Local state of the worker, NULL if workers have none
+ * @param slot Slot with the chunk
+ * @return 0 on success, anything else stops the ring once the slot is due to be written
+ */
+typedef int (*ringTransform_t)(void *argument, void *local, void *slot);
+
+/**
+ * Writes the transformed slot, called by the thread running ringExecute in the order of reading
+ * @param argument Argument of the ring
+ * @param slot Transformed slot
+ * @return 0 on success, anything else stops the ring and is returned by ringExecute
+ */
+typedef int (*ringWrite_t)(void *argument, void *slot);
+
+/**
+ * Initializes the local state of one worker
+ * @param argument Argument of the ring
+ * @param local Zeroed local state
+ * @return 0 on success, anything else fails every chunk the worker takes
+ */
+typedef int (*ringOpen_t)(void *argument, void *local);
+
+/**
+ * Releases the local state of one worker or the resources of one slot
+ * @param data Local state or slot
+ */
+typedef void (*ringRelease_t)(void *data);
+
+/**
+ * Ordered ring of chunks processed by a pool of worker threads
+ */
+typedef struct {
+    /// Size of one slot in bytes, slots start zeroed
+    size_t slotSize;
+    /// Size of the local state of one worker in bytes, 0 if workers have none
+    size_t localSize;
+    /// Argument passed to all callbacks
+    void *argument;
+    /// Status returned when the ring cannot allocate its memory
+    int allocationError;
+    /// Status returned when no worker can be started
+    int threadError;
+    /// Reads chunks
+    ringRead_t read;
+    /// Transforms chunks
+    ringTransform_t transform;
+    /// Writes transformed chunks
+    ringWrite_t write;
+    /// Initializes the local state of a worker, may be NULL
+    ringOpen_t open;
+    /// Releases the local state of a successfully opened worker, may be NULL
+    ringRelease_t close;
+    /// Releases the resources of a slot, may be NULL
+    ringRelease_t release;
+} ring_t;
+
+unsigned int ringThreads(void);
+int ringExecute(const ring_t *ring, unsigned int threads);
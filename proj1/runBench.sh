@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+
+# Throughput benchmark. Every scenario in bench/ runs proj1 with its cmd (and
+# args) on the input generated by proj1gen with the options in its input file,
+# LINES lines by default: ./runBench.sh [LINES]
+
+lines=${1:-1000000}
+data=$(mktemp -d)
+trap 'rm -rf "${data}"' EXIT
+
+printf "%-16s %10s %10s %10s %12s\n" "scenario" "lines" "MB" "MB/s" "lines/s"
+for d in bench/*/ ; do
+    name=$(basename ${d})
+    input=${data}/$(tr -c 'a-zA-Z0-9\n' '_' < ${d}/input).in
+    if [ ! -f "${input}" ]; then
+        ./../bin/proj1gen --lines ${lines} $(cat ${d}/input) > "${input}"
+    fi
+    inputLines=$(wc -l < "${input}")
+    inputBytes=$(wc -c < "${input}")
+    start=$(date +%s%N)
+    ./../bin/proj1 $(cat ${d}/args 2>/dev/null) ${d}/cmd < "${input}" > /dev/null
+    status=$?
+    end=$(date +%s%N)
+    if [ ${status} -ne 0 ]; then
+        echo "${name} failed with ${status}"
+        continue
+    fi
+    awk -v name="${name}" -v lines="${inputLines}" -v bytes="${inputBytes}" -v ns=$((end - start)) 'BEGIN {
+        seconds = ns / 1e9
+        printf "%-16s %10d %10.1f %10.1f %12.0f\n", name, lines, bytes / 1e6, bytes / 1e6 / seconds, lines / seconds
+    }'
+done
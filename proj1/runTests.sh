@@ -2,8 +2,21 @@
 
 for d in test/*/ ; do
     echo "$d starts"
-    ./../bin/proj1 ${d}/cmd < ${d}/test.in > ${d}/test.output
-    echo "$d outputs $?"
+    ./../bin/proj1 $(cat ${d}/args 2>/dev/null) ${d}/cmd < ${d}/test.in > ${d}/test.output
+    status=$?
+    echo "$d outputs $status"
     diff ${d}/test.out ${d}/test.output
+    # Files written by the test itself, like outputs of --batch
+    for expected in ${d}*.expected; do
+        [ -e "$expected" ] || continue
+        diff "$expected" "${expected%.expected}"
+        rm -f "${expected%.expected}"
+    done
+    if [ $status -eq 0 ] && ! grep -q -- --batch ${d}/args 2>/dev/null; then
+        # The same script run through the proj1edit library by several threads at once
+        ./../bin/proj1editTest $(cat ${d}/args 2>/dev/null) ${d}/cmd < ${d}/test.in > ${d}/test.output
+        echo "$d library outputs $?"
+        diff ${d}/test.out ${d}/test.output
+    fi
     rm ${d}/test.output
 done
\ No newline at end of file
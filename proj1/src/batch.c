@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Batch processing of many files by one compiled script. Every line of the
+ * manifest holds the path of an input file and, separated by a tab, the path
+ * of its output file ("INPUT.out" if it is missing). A bounded pool of worker
+ * threads takes the files one by one, so at most one file per thread is open
+ * at once no matter how long the manifest is.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "input.h"
+#include "proj1.h"
+
+/**
+ * Pair of files processed together
+ */
+typedef struct {
+    /// Path of the input file
+    char *input;
+    /// Path of the output file
+    char *output;
+    /// Execution status of the file
+    int status;
+} batchFile_t;
+
+/**
+ * Shared state of the batch processing
+ */
+typedef struct {
+    /// Files in the manifest order
+    batchFile_t *files;
+    /// Count of files
+    size_t count;
+    /// Index of the next file not taken by a worker
+    size_t next;
+    /// Processes one file
+    batchCallback_t callback;
+    /// Argument of the callback
+    void *argument;
+    /// Lock of the shared state
+    pthread_mutex_t lock;
+} batch_t;
+
+/**
+ * Duplicates the part of the string
+ * @param data First character
+ * @param length Length of the part
+ * @param suffix Suffix appended to the copy
+ * @return Copy of the part, NULL on error
+ */
+static char *copyPath(const char *data, size_t length, const char *suffix) {
+    size_t suffixLength = strlen(suffix);
+    char *path = malloc(length + suffixLength + 1);
+    if (path != NULL) {
+        memcpy(path, data, length);
+        memcpy(path + length, suffix, suffixLength + 1);
+    }
+    return path;
+}
+
+/**
+ * Reads all files of the manifest
+ * @param fd File descriptor of the manifest
+ * @param batch Batch with the read files
+ * @return Execution status
+ */
+static int readManifest(int fd, batch_t *batch) {
+    reader_t reader;
+    int status = readerOpen(&reader, fd);
+    if (status != NO_ERROR) {
+        return status;
+    }
+    size_t capacity = 0;
+    line_t line;
+    while ((status = readerNext(&reader, &line)) == NO_ERROR) {
+        if (line.length == 0) {
+            continue;
+        }
+        if (batch->count == capacity) {
+            capacity = 2 * capacity + 16;
+            batchFile_t *files = realloc(batch->files, capacity * sizeof(batchFile_t));
+            if (files == NULL) {
+                status = BUFFER_ERROR;
+                break;
+            }
+            batch->files = files;
+        }
+        batchFile_t *file = &batch->files[batch->count];
+        file->status = NO_ERROR;
+        const char *tab = memchr(line.data, '\t', line.length);
+        if (tab == NULL) {
+            file->input = copyPath(line.data, line.length, "");
+            file->output = copyPath(line.data, line.length, ".out");
+        } else {
+            file->input = copyPath(line.data, (size_t) (tab - line.data), "");
+            file->output = copyPath(tab + 1, line.length - (size_t) (tab - line.data) - 1, "");
+        }
+        batch->count++;
+        if (file->input == NULL || file->output == NULL) {
+            status = BUFFER_ERROR;
+            break;
+        }
+    }
+    readerClose(&reader);
+    return (status == FILE_END) ? NO_ERROR : status;
+}
+
+/**
+ * Worker thread, processes files until none is left
+ * @param argument Shared state of the batch processing
+ * @return Nothing
+ */
+static void *worker(void *argument) {
+    batch_t *batch = argument;
+    pthread_mutex_lock(&batch->lock);
+    while (batch->next < batch->count) {
+        batchFile_t *file = &batch->files[batch->next++];
+        pthread_mutex_unlock(&batch->lock);
+        // Only this worker touches the file until the workers are joined
+        file->status = batch->callback(file->input, file->output, batch->argument);
+        pthread_mutex_lock(&batch->lock);
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return NULL;
+}
+
+/**
+ * Processes all files of the manifest on the pool of threads
+ * Files which fail do not stop the others. The status of the first failed
+ * file in the manifest order is returned, whichever thread finishes first.
+ * @param manifest Path of the manifest, "-" for stdin
+ * @param threads Count of worker threads
+ * @param callback Processes one file
+ * @param argument Argument of the callback
+ * @return Execution status
+ */
+int batchExecute(const char *manifest, unsigned int threads, batchCallback_t callback, void *argument) {
+    batch_t batch = {NULL, 0, 0, callback, argument, PTHREAD_MUTEX_INITIALIZER};
+    int fd = (strcmp(manifest, "-") == 0) ? STDIN_FILENO : open(manifest, O_RDONLY);
+    if (fd < 0) {
+        perror("proj1");
+        return FILE_READ_ERROR;
+    }
+    int status = readManifest(fd, &batch);
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    if (threads > batch.count) {
+        threads = (unsigned int) batch.count;
+    }
+    pthread_t *workers = calloc(threads + 1, sizeof(pthread_t));
+    if (status == NO_ERROR && workers == NULL) {
+        status = BUFFER_ERROR;
+    }
+    unsigned int started = 0;
+    for (; status == NO_ERROR && started < threads; started++) {
+        if (pthread_create(&workers[started], NULL, worker, &batch) != 0) {
+            break;
+        }
+    }
+    if (status == NO_ERROR && started == 0) {
+        // No thread could be started, the files are processed by this one
+        worker(&batch);
+    }
+    for (unsigned int i = 0; i < started; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    for (size_t i = 0; status == NO_ERROR && i < batch.count; i++) {
+        status = batch.files[i].status;
+    }
+    for (size_t i = 0; i < batch.count; i++) {
+        free(batch.files[i].input);
+        free(batch.files[i].output);
+    }
+    free(batch.files);
+    free(workers);
+    return status;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * Processes one input file into one output file
+ * @param input Path of the input file
+ * @param output Path of the output file
+ * @param argument Argument given to batchExecute
+ * @return Execution status
+ */
+typedef int (*batchCallback_t)(const char *input, const char *output, void *argument);
+
+int batchExecute(const char *manifest, unsigned int threads, batchCallback_t callback, void *argument);
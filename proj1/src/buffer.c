@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "buffer.h"
+#include "proj1.h"
+
+/// Minimal capacity of the allocated memory
+#define BUFFER_MIN_CAPACITY 64
+
+/**
+ * Reserves the memory for the string of the length
+ * @param buffer Buffer
+ * @param length Length of the string
+ * @return Execution status
+ */
+int bufferReserve(buffer_t *buffer, size_t length) {
+    if (length < buffer->capacity) {
+        return NO_ERROR;
+    }
+    size_t capacity = (buffer->capacity < BUFFER_MIN_CAPACITY) ? BUFFER_MIN_CAPACITY : buffer->capacity;
+    while (capacity <= length) {
+        capacity *= 2;
+    }
+    char *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        return BUFFER_ERROR;
+    }
+    if (buffer->data == NULL) {
+        data[0] = '\0';
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return NO_ERROR;
+}
+
+/**
+ * Appends data to the end of the string
+ * @param buffer Buffer
+ * @param data Data to append
+ * @param length Length of the data
+ * @return Execution status
+ */
+int bufferAppend(buffer_t *buffer, const char *data, size_t length) {
+    return bufferReplace(buffer, buffer->length, 0, data, length);
+}
+
+/**
+ * Prepends data to the beginning of the string
+ * @param buffer Buffer
+ * @param data Data to prepend
+ * @param length Length of the data
+ * @return Execution status
+ */
+int bufferPrepend(buffer_t *buffer, const char *data, size_t length) {
+    return bufferReplace(buffer, 0, 0, data, length);
+}
+
+/**
+ * Replaces the part of the string
+ * @param buffer Buffer
+ * @param offset Offset of the replaced part
+ * @param length Length of the replaced part
+ * @param data Replacement
+ * @param dataLength Length of the replacement
+ * @return Execution status
+ */
+int bufferReplace(buffer_t *buffer, size_t offset, size_t length, const char *data, size_t dataLength) {
+    if (bufferReserve(buffer, buffer->length - length + dataLength) != NO_ERROR) {
+        return BUFFER_ERROR;
+    }
+    char *start = buffer->data + offset;
+    memmove(start + dataLength, start + length, buffer->length - offset - length + 1);
+    if (dataLength > 0) {
+        memcpy(start, data, dataLength);
+    }
+    buffer->length = buffer->length - length + dataLength;
+    return NO_ERROR;
+}
+
+/**
+ * Clears the string, the memory is kept for the reuse
+ * @param buffer Buffer
+ */
+void bufferClear(buffer_t *buffer) {
+    buffer->length = 0;
+    if (buffer->data != NULL) {
+        buffer->data[0] = '\0';
+    }
+}
+
+/**
+ * Frees the memory of the string
+ * @param buffer Buffer
+ */
+void bufferFree(buffer_t *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = buffer->capacity = 0;
+}
+
+/**
+ * Appends the fragment to the end of the list
+ * @param fragments List of fragments
+ * @param data Fragment, it must outlive the list
+ * @param length Length of the fragment
+ * @return Execution status
+ */
+int fragmentsAppend(fragments_t *fragments, const char *data, size_t length) {
+    if (fragments->count == fragments->capacity) {
+        size_t capacity = 2 * fragments->capacity + 8;
+        struct iovec *items = realloc(fragments->data, capacity * sizeof(struct iovec));
+        if (items == NULL) {
+            return BUFFER_ERROR;
+        }
+        fragments->data = items;
+        fragments->capacity = capacity;
+    }
+    fragments->data[fragments->count++] = (struct iovec) {(void *) data, length};
+    return NO_ERROR;
+}
+
+/**
+ * Clears the list, the memory is kept for the reuse
+ * @param fragments List of fragments
+ */
+void fragmentsClear(fragments_t *fragments) {
+    fragments->count = 0;
+}
+
+/**
+ * Frees the memory of the list, the fragments are kept
+ * @param fragments List of fragments
+ */
+void fragmentsFree(fragments_t *fragments) {
+    free(fragments->data);
+    fragments->data = NULL;
+    fragments->count = fragments->capacity = 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+/**
+ * Growable string, the data are always terminated by NUL
+ */
+typedef struct {
+    /// Characters of the string
+    char *data;
+    /// Length of the string
+    size_t length;
+    /// Capacity of the allocated memory
+    size_t capacity;
+} buffer_t;
+
+/**
+ * Growable list of fragments of a text, the fragments are not copied
+ */
+typedef struct {
+    /// Fragments, they point to texts which outlive the list
+    struct iovec *data;
+    /// Count of fragments
+    size_t count;
+    /// Capacity of the allocated memory
+    size_t capacity;
+} fragments_t;
+
+int bufferReserve(buffer_t *buffer, size_t length);
+
+int bufferAppend(buffer_t *buffer, const char *data, size_t length);
+
+int bufferPrepend(buffer_t *buffer, const char *data, size_t length);
+
+int bufferReplace(buffer_t *buffer, size_t offset, size_t length, const char *data, size_t dataLength);
+
+void bufferClear(buffer_t *buffer);
+
+void bufferFree(buffer_t *buffer);
+
+int fragmentsAppend(fragments_t *fragments, const char *data, size_t length);
+
+void fragmentsClear(fragments_t *fragments);
+
+void fragmentsFree(fragments_t *fragments);
@@ -0,0 +1,5 @@
+#pragma once
+
+int strToULong(const char *string, unsigned long *number);
+
+int strToDouble(const char *string, double *number);
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Library front end of the editing engine. The program object owns the
+ * compiled script and its per-line transformation, executions read the span
+ * of the caller through a borrowed reader and write into the sink of the
+ * caller, so nothing is shared between executions except the read-only
+ * program. The context keeps the lazily built DFAs of the matchers and the
+ * small writer buffer of one thread, so repeated executions of the program
+ * allocate nothing once the DFAs are warm.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "execute.h"
+#include "proj1edit.h"
+
+/**
+ * Compiled script
+ */
+struct editProgram {
+    /// Compiled program
+    program_t program;
+    /// Per-line transformation of the program
+    loop_t loop;
+    /// Is the per-line transformation available?
+    bool fused;
+    /// Apply substitutions one after another?
+    bool sequential;
+};
+
+/**
+ * Reusable state of executions of one program by one thread
+ */
+struct editContext {
+    /// Executed program
+    const editProgram_t *program;
+    /// Matchers of the regular expressions of the program
+    substituteContext_t substitute;
+    /// Writer into the sink of the current execution
+    writer_t writer;
+};
+
+/**
+ * Compiles the script
+ * Errors in the script are described on stderr.
+ * @param script Script, one command per line, it is not needed after the compilation
+ * @param length Length of the script
+ * @param flags Flags of the compilation (enum editFlags)
+ * @param program Compiled script, NULL on failure
+ * @return Execution status
+ */
+int editCompile(const char *script, size_t length, unsigned int flags, editProgram_t **program) {
+    *program = NULL;
+    editProgram_t *compiled = malloc(sizeof(editProgram_t));
+    if (compiled == NULL) {
+        return BUFFER_ERROR;
+    }
+    int status = programCompileMemory(script, length, &compiled->program, (flags & EDIT_REGEXP) != 0);
+    if (status != NO_ERROR) {
+        free(compiled);
+        return status;
+    }
+    compiled->fused = loopAnalyse(&compiled->program, &compiled->loop);
+    compiled->sequential = (flags & EDIT_SEQUENTIAL) != 0;
+    *program = compiled;
+    return NO_ERROR;
+}
+
+/**
+ * Creates the execution context of the compiled script
+ * @param program Compiled script, it must outlive the context
+ * @param context Execution context, NULL on failure
+ * @return Execution status
+ */
+int editContextCreate(const editProgram_t *program, editContext_t **context) {
+    *context = NULL;
+    editContext_t *created = malloc(sizeof(editContext_t));
+    if (created == NULL) {
+        return BUFFER_ERROR;
+    }
+    created->program = program;
+    if (substituteContextOpen(&created->substitute, program->program.regexpCount) != NO_ERROR) {
+        free(created);
+        return BUFFER_ERROR;
+    }
+    if (writerOpenSink(&created->writer, NULL, NULL) != NO_ERROR) {
+        writerClose(&created->writer);
+        substituteContextClose(&created->substitute);
+        free(created);
+        return BUFFER_ERROR;
+    }
+    *context = created;
+    return NO_ERROR;
+}
+
+/**
+ * Executes the compiled script of the context on the input
+ * @param context Execution context, used by one thread at a time
+ * @param input Input, it is not modified
+ * @param length Length of the input
+ * @param sink Consumer of the output
+ * @param argument Argument of the consumer
+ * @return Execution status
+ */
+int editExecuteWith(editContext_t *context, const char *input, size_t length, editSink_t sink, void *argument) {
+    const editProgram_t *program = context->program;
+    reader_t reader;
+    readerOpenMemory(&reader, input, length);
+    writerSetSink(&context->writer, sink, argument);
+    script_t script = {&program->program, program->fused ? &program->loop : NULL, program->sequential};
+    int status = executeScript(&script, 1, &context->substitute, &reader, &context->writer, NULL);
+    readerClose(&reader);
+    return status;
+}
+
+/**
+ * Frees the execution context
+ * @param context Execution context, may be NULL
+ */
+void editContextFree(editContext_t *context) {
+    if (context == NULL) {
+        return;
+    }
+    writerClose(&context->writer);
+    substituteContextClose(&context->substitute);
+    free(context);
+}
+
+/**
+ * Executes the compiled script on the input with a temporary context
+ * @param program Compiled script
+ * @param input Input, it is not modified
+ * @param length Length of the input
+ * @param sink Consumer of the output
+ * @param argument Argument of the consumer
+ * @return Execution status
+ */
+int editExecute(const editProgram_t *program, const char *input, size_t length, editSink_t sink, void *argument) {
+    editContext_t *context;
+    int status = editContextCreate(program, &context);
+    if (status == NO_ERROR) {
+        status = editExecuteWith(context, input, length, sink, argument);
+    }
+    editContextFree(context);
+    return status;
+}
+
+/**
+ * Frees the compiled script
+ * @param program Compiled script, may be NULL
+ */
+void editFree(editProgram_t *program) {
+    if (program == NULL) {
+        return;
+    }
+    if (program->fused) {
+        loopFree(&program->loop);
+    }
+    programFree(&program->program);
+    free(program);
+}
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Test of the proj1edit library. The script is compiled once and executed on
+ * stdin by several threads at once, every thread collects its own output
+ * through a sink. Every thread executes the program twice with its own
+ * context, so the second execution reuses the state left by the first one.
+ * All outputs must be equal, the first one is printed, so runTests.sh
+ * compares it with the expected output of the proj1 executable.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "proj1edit.h"
+
+/// Count of threads executing the program at once
+#define EDIT_TEST_THREADS 4
+/// Count of executions by one thread
+#define EDIT_TEST_REPEATS 2
+
+/**
+ * Growing block of memory
+ */
+typedef struct {
+    /// Data
+    char *data;
+    /// Length of the data
+    size_t length;
+    /// Capacity of the block
+    size_t capacity;
+} block_t;
+
+/**
+ * One execution of the program
+ */
+typedef struct {
+    /// Compiled script
+    const editProgram_t *program;
+    /// Input
+    const block_t *input;
+    /// Collected output
+    block_t output;
+    /// Execution status
+    int status;
+} run_t;
+
+/**
+ * Appends data to the block
+ * @param block Block
+ * @param data Appended data
+ * @param length Length of the data
+ * @return Execution status
+ */
+static int blockAppend(block_t *block, const char *data, size_t length) {
+    if (block->capacity - block->length < length) {
+        size_t capacity = 2 * (block->length + length);
+        char *grown = realloc(block->data, capacity);
+        if (grown == NULL) {
+            return BUFFER_ERROR;
+        }
+        block->data = grown;
+        block->capacity = capacity;
+    }
+    memcpy(block->data + block->length, data, length);
+    block->length += length;
+    return NO_ERROR;
+}
+
+/**
+ * Reads the whole stream into the block
+ * @param stream Stream
+ * @param block Block
+ * @return Execution status
+ */
+static int blockRead(FILE *stream, block_t *block) {
+    char chunk[1 << 16];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), stream)) > 0) {
+        if (blockAppend(block, chunk, length) != NO_ERROR) {
+            return BUFFER_ERROR;
+        }
+    }
+    return ferror(stream) ? FILE_READ_ERROR : NO_ERROR;
+}
+
+/**
+ * Sink collecting the output of one execution
+ * @param data Piece of the output
+ * @param length Length of the piece
+ * @param argument Output block
+ * @return Execution status
+ */
+static int collect(const char *data, size_t length, void *argument) {
+    return blockAppend(argument, data, length);
+}
+
+/**
+ * Thread executing the program repeatedly with one context, the last output is kept
+ * @param argument Execution
+ * @return Nothing
+ */
+static void *execute(void *argument) {
+    run_t *run = argument;
+    editContext_t *context;
+    run->status = editContextCreate(run->program, &context);
+    for (int i = 0; i < EDIT_TEST_REPEATS && run->status == NO_ERROR; i++) {
+        run->output.length = 0;
+        run->status = editExecuteWith(context, run->input->data, run->input->length, collect, &run->output);
+    }
+    editContextFree(context);
+    return NULL;
+}
+
+/**
+ * Main program function
+ * @param argc Count of arguments
+ * @param argv Program's arguments, the same options as of proj1 except -j
+ * @return Execution status of the executions
+ */
+int main(int argc, char *argv[]) {
+    unsigned int flags = 0;
+    for (; argc > 2; argc--, argv++) {
+        if ((strcmp(argv[1], "--regexp") == 0) || (strcmp(argv[1], "-E") == 0)) {
+            flags |= EDIT_REGEXP;
+        } else if (strcmp(argv[1], "--sequential") == 0) {
+            flags |= EDIT_SEQUENTIAL;
+        } else {
+            break;
+        }
+    }
+    if (argc != 2) {
+        puts("Usage: ./proj1editTest [-E] [--sequential] file_with_commands < input");
+        return CONVERSION_ERROR;
+    }
+    block_t script = {NULL, 0, 0};
+    block_t input = {NULL, 0, 0};
+    FILE *commands = fopen(argv[1], "rb");
+    if (commands == NULL) {
+        perror("proj1editTest");
+        return FILE_READ_ERROR;
+    }
+    int status = blockRead(commands, &script);
+    fclose(commands);
+    if (status == NO_ERROR) {
+        status = blockRead(stdin, &input);
+    }
+    editProgram_t *program = NULL;
+    if (status == NO_ERROR) {
+        status = editCompile(script.data, script.length, flags, &program);
+    }
+    free(script.data);
+    if (status != NO_ERROR) {
+        free(input.data);
+        return status;
+    }
+    run_t runs[EDIT_TEST_THREADS];
+    pthread_t threads[EDIT_TEST_THREADS];
+    size_t started = 0;
+    for (; started < EDIT_TEST_THREADS; started++) {
+        runs[started] = (run_t) {program, &input, {NULL, 0, 0}, NO_ERROR};
+        if (pthread_create(&threads[started], NULL, execute, &runs[started]) != 0) {
+            break;
+        }
+    }
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    status = runs[0].status;
+    if (started < EDIT_TEST_THREADS) {
+        // The test is about concurrent executions, it cannot pass without them
+        fprintf(stderr, "Cannot start a thread.\n");
+        status = BUFFER_ERROR;
+    }
+    for (size_t i = 1; i < started; i++) {
+        if (runs[i].status != status || runs[i].output.length != runs[0].output.length ||
+            (runs[0].output.length > 0 &&
+             memcmp(runs[i].output.data, runs[0].output.data, runs[0].output.length) != 0)) {
+            fprintf(stderr, "Outputs of concurrent executions differ.\n");
+            status = OUTPUT_WRITE_ERROR;
+        }
+    }
+    if (started > 0) {
+        fwrite(runs[0].output.data, 1, runs[0].output.length, stdout);
+    }
+    for (size_t i = 0; i < started; i++) {
+        free(runs[i].output.data);
+    }
+    free(input.data);
+    editFree(program);
+    return status;
+}
@@ -0,0 +1,444 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Execution of compiled scripts. Programs transforming every line
+ * independently are executed as a fused loop over the input lines, other
+ * programs are interpreted command by command. The execution only talks to
+ * the reader and the writer, so the same engine serves files, standard
+ * streams and spans of the memory of embedding callers.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "buffer.h"
+#include "execute.h"
+#include "parallel.h"
+#include "proj1.h"
+#include "substitute.h"
+
+/**
+ * State of the program execution
+ */
+typedef struct {
+    /// Input reader
+    reader_t *reader;
+    /// Output writer
+    writer_t *writer;
+    /// Texts before the next line in the reverse order
+    fragments_t before;
+    /// Texts after the next line
+    fragments_t after;
+    /// Fragments of the printed line
+    fragments_t line;
+    /// Output buffer for lines with substitutions
+    buffer_t outputBuffer;
+    /// Apply substitutions one after another?
+    bool sequential;
+    /// Print the new line after the next line?
+    bool newLine;
+    /// Count of instructions executed since the input was read
+    size_t idle;
+    /// Pending substitution commands
+    substituteCmds_t substituteCmds;
+    /// State of substitutions
+    substituteContext_t *substituteContext;
+    /// Profile of the execution, NULL if it is disabled
+    profile_t *profile;
+} execution_t;
+
+/**
+ * Chack if execution has error status
+ * @param status Execution status
+ * @return Has error status?
+ */
+static bool checkStatus(int status) {
+    return (status != NO_ERROR);
+}
+
+/**
+ * Add substitution command to the buffer
+ * @param instruction Substitution command
+ * @param substituteCmds Buffer with sunbstitution commands
+ * @return Execution status
+ */
+static int addSubstituteCommand(const instruction_t *instruction, substituteCmds_t *substituteCmds) {
+    if (substituteCmds->count == COMMAND_SIZE) {
+        fprintf(stderr, "Too much command for substitution.\n");
+        return UNKNOWN_COMMAND;
+    }
+    substituteCmds->cmds[substituteCmds->count] = instruction;
+    substituteCmds->count++;
+    return NO_ERROR;
+}
+
+/**
+ * Apply substitution commands on the user's input
+ * @param execution Execution state
+ * @param line Fragments of the line
+ * @param output Buffer for the substituted line
+ * @return Execution status
+ */
+static int applySubstitutionCommands(execution_t *execution, const fragments_t *line, buffer_t *output) {
+    substituteCmds_t *commands = &execution->substituteCmds;
+    int status = NO_ERROR;
+    bufferClear(output);
+    if (execution->sequential) {
+        for (size_t i = 0; i < line->count && !checkStatus(status); i++) {
+            status = bufferAppend(output, line->data[i].iov_base, line->data[i].iov_len);
+        }
+        if (!checkStatus(status)) {
+            status = substituteApplySequential(commands, execution->substituteContext, output);
+        }
+    } else {
+        status = substituteApplyFragments(commands, execution->substituteContext, line->data, line->count, output);
+    }
+    commands->count = 0;
+    return status;
+}
+
+/**
+ * Command for line deletion
+ * Deleted lines are counted in raw blocks of the input without splitting them
+ * into lines.
+ * @param instruction Command
+ * @param execution Execution state
+ * @return Execution status
+ */
+static int commandDelete(const instruction_t *instruction, execution_t *execution) {
+    size_t count = (instruction->count > 0) ? (size_t) instruction->count : 0;
+    while (count > 0) {
+        const char *data;
+        size_t length;
+        size_t lines;
+        int status = readerLines(execution->reader, count, &data, &length, &lines);
+        if (checkStatus(status)) {
+            return status;
+        }
+        count -= lines;
+        execution->idle = 0;
+        if (execution->profile != NULL) {
+            execution->profile->lines += lines;
+        }
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Add EOL after the current line
+ * @param after Texts after the line
+ * @return Execution status
+ */
+static int commandAddEol(fragments_t *after) {
+    return fragmentsAppend(after, "\n", 1);
+}
+
+/**
+ * Command for line insertion
+ * @param instruction Command
+ * @param writer Output writer
+ * @return Execution status
+ */
+static int commandInsert(const instruction_t *instruction, writer_t *writer) {
+    struct iovec fragments[] = {{instruction->text, instruction->textLength}, {"\n", 1}};
+    return writerWriteFragments(writer, fragments, 2);
+}
+
+/**
+ * Print the line with the texts around it and pending substitutions
+ * The line is printed as the list of fragments pointing to the input buffer
+ * and to the texts of commands, only substituted lines are assembled in the
+ * output buffer.
+ * @param line Line
+ * @param execution Execution state
+ * @return Execution status
+ */
+static int printLine(line_t line, execution_t *execution) {
+    fragments_t *before = &execution->before;
+    fragments_t *after = &execution->after;
+    fragments_t *fragments = &execution->line;
+    int status = NO_ERROR;
+    if (execution->newLine) {
+        status = commandAddEol(after);
+    } else {
+        execution->newLine = true;
+    }
+    fragmentsClear(fragments);
+    for (size_t i = before->count; i > 0 && !checkStatus(status); i--) {
+        status = fragmentsAppend(fragments, before->data[i - 1].iov_base, before->data[i - 1].iov_len);
+    }
+    if (!checkStatus(status)) {
+        status = fragmentsAppend(fragments, line.data, line.length);
+    }
+    for (size_t i = 0; i < after->count && !checkStatus(status); i++) {
+        status = fragmentsAppend(fragments, after->data[i].iov_base, after->data[i].iov_len);
+    }
+    if (checkStatus(status)) {
+        return status;
+    }
+    if (execution->substituteCmds.count == 0) {
+        status = writerWriteFragments(execution->writer, fragments->data, fragments->count);
+    } else {
+        buffer_t *outputBuffer = &execution->outputBuffer;
+        if (applySubstitutionCommands(execution, fragments, outputBuffer)) {
+            return BUFFER_ERROR;
+        }
+        status = writerWrite(execution->writer, outputBuffer->data, outputBuffer->length);
+    }
+    fragmentsClear(before);
+    fragmentsClear(after);
+    execution->idle = 0;
+    if (execution->profile != NULL) {
+        execution->profile->lines++;
+    }
+    return status;
+}
+
+/**
+ * Command for line(s) printing
+ * Only the first line can have anything around it, the following lines are
+ * printed as raw blocks of the input without splitting them into lines.
+ * @param instruction Command
+ * @param execution Execution state
+ * @return Execution status
+ */
+static int commandNext(const instruction_t *instruction, execution_t *execution) {
+    if (instruction->count <= 0) {
+        return NO_ERROR;
+    }
+    line_t line;
+    int status = readerNext(execution->reader, &line);
+    if (checkStatus(status)) {
+        return status;
+    }
+    status = printLine(line, execution);
+    size_t count = (size_t) instruction->count - 1;
+    while (!checkStatus(status) && count > 0) {
+        const char *data;
+        size_t length;
+        size_t lines;
+        status = readerLines(execution->reader, count, &data, &length, &lines);
+        if (checkStatus(status)) {
+            break;
+        }
+        count -= lines;
+        if (execution->profile != NULL) {
+            execution->profile->lines += lines;
+        }
+        status = writerWrite(execution->writer, data, length);
+        if (!checkStatus(status) && data[length - 1] != '\n') {
+            // The last line of the input has no new line
+            status = writerWrite(execution->writer, "\n", 1);
+        }
+    }
+    return status;
+}
+
+/**
+ * Command for printing lines until the next line contains the pattern
+ * The first line is printed like by n, the following lines have nothing
+ * around them, so they are searched in the input buffer at once and printed
+ * as blocks without splitting them into lines.
+ * @param instruction Command
+ * @param execution Execution state
+ * @return Execution status
+ */
+static int commandFind(const instruction_t *instruction, execution_t *execution) {
+    line_t line;
+    int status = readerPeek(execution->reader, &line);
+    if (checkStatus(status)) {
+        return status;
+    }
+    if (searchFind(&instruction->searcher, line.data, line.length, 0) != SEARCH_NONE) {
+        return NO_ERROR;
+    }
+    status = readerNext(execution->reader, &line);
+    if (!checkStatus(status)) {
+        status = printLine(line, execution);
+    }
+    bool found = false;
+    while (!checkStatus(status) && !found) {
+        const char *data;
+        size_t length;
+        status = readerSkip(execution->reader, &instruction->searcher, &data, &length, &found);
+        if (!checkStatus(status)) {
+            status = writerWrite(execution->writer, data, length);
+        }
+        for (size_t i = 0; execution->profile != NULL && !checkStatus(status) && i < length; i++) {
+            execution->profile->lines += (data[i] == '\n' || i + 1 == length);
+        }
+        if (!checkStatus(status) && !found && data[length - 1] != '\n') {
+            // The last line of the input has no new line
+            status = writerWrite(execution->writer, "\n", 1);
+        }
+    }
+    return status;
+}
+
+/**
+ * Checks if the next line contains the pattern of the conditioned goto
+ * @param instruction Command
+ * @param execution Execution state
+ * @param jump Jump to the target?
+ * @return Execution status
+ */
+static int commandConditionedGoto(const instruction_t *instruction, execution_t *execution, bool *jump) {
+    line_t line;
+    int status = readerPeek(execution->reader, &line);
+    *jump = (status == NO_ERROR) && searchFind(&instruction->searcher, line.data, line.length, 0) != SEARCH_NONE;
+    return (status == FILE_END) ? NO_ERROR : status;
+}
+
+/**
+ * Execute the compiled program
+ * @param program Compiled command script
+ * @param execution Execution state
+ * @return Execution status
+ */
+static int executeProgram(const program_t *program, execution_t *execution) {
+    profile_t *profile = execution->profile;
+    int status = NO_ERROR;
+    size_t pc = 0;
+    bool jump;
+    bool quit = false;
+    uint64_t start = 0;
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+    while (pc < program->count && !quit) {
+        if (++execution->idle > program->count) {
+            // Some instruction repeats without reading the input, so it repeats forever
+            fprintf(stderr, "Infinite loop without reading the input on the line %zu.\n", pc + 1);
+            return INFINITE_LOOP;
+        }
+        size_t index = pc;
+        const instruction_t *instruction = &program->instructions[pc++];
+        if (profile != NULL) {
+            start = profileClock();
+            bytesIn = readerTell(execution->reader);
+            bytesOut = execution->writer->total;
+        }
+        switch (instruction->cmd) {
+            case CMD_APPEND:
+                status = fragmentsAppend(&execution->after, instruction->text, instruction->textLength);
+                break;
+            case CMD_BEFORE:
+                status = fragmentsAppend(&execution->before, instruction->text, instruction->textLength);
+                break;
+            case CMD_INSERT:
+                status = commandInsert(instruction, execution->writer);
+                break;
+            case CMD_DELETE:
+                status = commandDelete(instruction, execution);
+                break;
+            case CMD_REMOVE:
+                execution->newLine = false;
+                break;
+            case CMD_NEXT:
+                status = commandNext(instruction, execution);
+                break;
+            case CMD_GOTO:
+                pc = (size_t) instruction->count;
+                break;
+            case CMD_FIND:
+                status = commandFind(instruction, execution);
+                break;
+            case CMD_CONDITIONED_GOTO:
+                status = commandConditionedGoto(instruction, execution, &jump);
+                if (jump) {
+                    pc = (size_t) instruction->count;
+                }
+                break;
+            case CMD_EOL:
+                status = commandAddEol(&execution->after);
+                break;
+            case CMD_SUBSTITUTE:
+            case CMD_SUBSTITUTE_ALL:
+                status = addSubstituteCommand(instruction, &execution->substituteCmds);
+                break;
+            case CMD_QUIT:
+                quit = true;
+                break;
+        }
+        if (profile != NULL) {
+            profileRecord(&profile->entries[index], start, readerTell(execution->reader) - bytesIn,
+                          execution->writer->total - bytesOut);
+        }
+        if (checkStatus(status)) {
+            return status;
+        }
+    }
+    if (quit) {
+        return NO_ERROR;
+    }
+    if (profile != NULL) {
+        start = profileClock();
+        bytesIn = readerTell(execution->reader);
+        bytesOut = execution->writer->total;
+    }
+    status = writerPassthrough(execution->writer, execution->reader, (profile != NULL) ? &profile->lines : NULL);
+    if (profile != NULL) {
+        profileRecord(&profile->rest, start, readerTell(execution->reader) - bytesIn,
+                      execution->writer->total - bytesOut);
+    }
+    return status;
+}
+
+/**
+ * Execute the compiled script
+ * Programs transforming every line independently are executed as a fused loop
+ * over the input lines, in parallel if more threads are available.
+ * @param script Compiled script
+ * @param jobs Count of threads
+ * @param context State of substitutions opened for the program and kept by the caller, NULL to open a temporary one
+ * @param reader Reader of the input
+ * @param writer Writer of the output, it is flushed at the end
+ * @param profile Profile of the execution, NULL if it is disabled
+ * @return Execution status
+ */
+int executeScript(const script_t *script, unsigned int jobs, substituteContext_t *context, reader_t *reader,
+                  writer_t *writer, profile_t *profile) {
+    execution_t execution = {.reader = reader, .writer = writer, .newLine = true, .sequential = script->sequential,
+                             .substituteContext = context, .profile = profile};
+    substituteContext_t temporary;
+    int status = NO_ERROR;
+    if (context == NULL) {
+        status = substituteContextOpen(&temporary, script->program->regexpCount);
+        execution.substituteContext = &temporary;
+    }
+    if (status == NO_ERROR) {
+        if (script->loop == NULL) {
+            status = executeProgram(script->program, &execution);
+        } else if (jobs > 1) {
+            status = parallelExecute(script->loop, reader, writer, jobs, execution.sequential);
+        } else {
+            status = loopExecute(script->loop, execution.substituteContext, reader, writer, execution.sequential);
+        }
+    }
+    if (writerFlush(writer) != NO_ERROR && (status == NO_ERROR || status == FILE_END)) {
+        status = OUTPUT_WRITE_ERROR;
+    }
+    fragmentsFree(&execution.before);
+    fragmentsFree(&execution.after);
+    fragmentsFree(&execution.line);
+    bufferFree(&execution.outputBuffer);
+    if (context == NULL) {
+        substituteContextClose(&temporary);
+    }
+    return (status == FILE_END) ? NO_ERROR : status;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "input.h"
+#include "loop.h"
+#include "output.h"
+#include "profile.h"
+#include "program.h"
+#include "substitute.h"
+
+/**
+ * Compiled script shared by all executions
+ */
+typedef struct {
+    /// Compiled program
+    const program_t *program;
+    /// Per-line transformation of the program, NULL if the program must be interpreted
+    const loop_t *loop;
+    /// Apply substitutions one after another?
+    bool sequential;
+} script_t;
+
+int executeScript(const script_t *script, unsigned int jobs, substituteContext_t *context, reader_t *reader,
+                  writer_t *writer, profile_t *profile);
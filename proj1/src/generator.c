@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Generator of large inputs for the proj1 throughput benchmark. Lines consist
+ * of random lowercase words, their lengths follow the chosen distribution and
+ * the pattern of the benchmarked substitutions is inserted with the chosen
+ * average count of occurrences per line. The output depends only on the
+ * arguments, so every benchmark run processes the same input.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "convert.h"
+
+/// Size of the stdout buffer
+#define GENERATOR_BUFFER_SIZE (1 << 18)
+
+/**
+ * Exit codes
+ */
+enum exitStatuses {
+    NO_ERROR,
+    CONVERSION_ERROR,
+    ARGUMENT_ERROR,
+    OUTPUT_WRITE_ERROR,
+};
+
+/**
+ * Distributions of the line length
+ */
+enum distributions {
+    /// Every line has the same length
+    DIST_FIXED,
+    /// Lengths are uniform between the minimum and the maximum
+    DIST_UNIFORM,
+    /// Lengths are exponential with the mean, so most lines are short and some are very long
+    DIST_EXPONENTIAL,
+};
+
+/**
+ * Generator settings
+ */
+typedef struct {
+    /// Count of lines
+    unsigned long lines;
+    /// Distribution of the line length
+    enum distributions distribution;
+    /// Minimal (or fixed) length of the line
+    unsigned long minimum;
+    /// Maximal length of the line (uniform) or the mean length (exponential)
+    unsigned long maximum;
+    /// Inserted pattern
+    const char *pattern;
+    /// Average count of pattern occurrences per line
+    double density;
+    /// Seed of the random generator
+    uint64_t seed;
+} settings_t;
+
+/**
+ * Generates the next pseudo-random number (xorshift64*)
+ * @param state State of the generator
+ * @return Pseudo-random number
+ */
+static uint64_t nextRandom(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1Dull;
+}
+
+/**
+ * Generates the pseudo-random number from [0, 1)
+ * @param state State of the generator
+ * @return Pseudo-random number
+ */
+static double nextUniform(uint64_t *state) {
+    return (double) (nextRandom(state) >> 11) * 0x1p-53;
+}
+
+/**
+ * Draws the length of the next line
+ * @param settings Generator settings
+ * @param state State of the generator
+ * @return Length of the line
+ */
+static size_t lineLength(const settings_t *settings, uint64_t *state) {
+    switch (settings->distribution) {
+        case DIST_UNIFORM:
+            return settings->minimum + nextRandom(state) % (settings->maximum - settings->minimum + 1);
+        case DIST_EXPONENTIAL:
+            return settings->minimum + (size_t) (-log(1 - nextUniform(state)) * settings->maximum);
+        default:
+            return settings->minimum;
+    }
+}
+
+/**
+ * Fills the line with random words and inserts occurrences of the pattern
+ * @param settings Generator settings
+ * @param state State of the generator
+ * @param line Line
+ * @param length Length of the line
+ */
+static void fillLine(const settings_t *settings, uint64_t *state, char *line, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint64_t random = nextRandom(state) >> 32;
+        line[i] = (random % 6 == 0) ? ' ' : (char) ('a' + random % 26);
+    }
+    size_t patternLength = strlen(settings->pattern);
+    if (patternLength == 0 || patternLength > length) {
+        return;
+    }
+    double occurrences = settings->density;
+    while (occurrences > 0) {
+        if (occurrences < 1 && nextUniform(state) >= occurrences) {
+            break;
+        }
+        size_t position = nextRandom(state) % (length - patternLength + 1);
+        memcpy(line + position, settings->pattern, patternLength);
+        occurrences -= 1;
+    }
+}
+
+/**
+ * Writes all lines into stdout
+ * @param settings Generator settings
+ * @return Execution status
+ */
+static int generate(const settings_t *settings) {
+    static char buffer[GENERATOR_BUFFER_SIZE];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    uint64_t state = settings->seed ? settings->seed : 1;
+    size_t capacity = 0;
+    char *line = NULL;
+    int status = NO_ERROR;
+    for (unsigned long i = 0; i < settings->lines && status == NO_ERROR; i++) {
+        size_t length = lineLength(settings, &state);
+        if (length + 1 > capacity) {
+            capacity = 2 * (length + 1);
+            char *resized = realloc(line, capacity);
+            if (resized == NULL) {
+                status = OUTPUT_WRITE_ERROR;
+                break;
+            }
+            line = resized;
+        }
+        fillLine(settings, &state, line, length);
+        line[length] = '\n';
+        if (fwrite(line, 1, length + 1, stdout) != length + 1) {
+            status = OUTPUT_WRITE_ERROR;
+        }
+    }
+    free(line);
+    if (fflush(stdout) != 0) {
+        status = OUTPUT_WRITE_ERROR;
+    }
+    if (status != NO_ERROR) {
+        perror("proj1gen");
+    }
+    return status;
+}
+
+/**
+ * Print program's usage
+ * @return Execution status
+ */
+int printUsage() {
+    puts("Usage: ./proj1gen [options] > input");
+    puts("Options:");
+    puts("\t--lines N\t\tGenerates N lines (default 1000000)");
+    puts("\t--fixed LENGTH\t\tEvery line is LENGTH characters long");
+    puts("\t--uniform MIN MAX\tLine lengths are uniform between MIN and MAX (default 0 120)");
+    puts("\t--exponential MIN MEAN\tLine lengths are MIN plus exponential lengths with the MEAN");
+    puts("\t--pattern PATTERN\tInserts PATTERN into lines (default abc)");
+    puts("\t--density D\t\tInserts PATTERN D times per line on average (default 0.5)");
+    puts("\t--seed S\t\tSeeds the random generator (default 1)");
+    puts("\t-h, --help\t\tPrints help (this message) and exits");
+    return NO_ERROR;
+}
+
+/**
+ * Main program function
+ * @param argc Count of arguments
+ * @param argv Program's arguments
+ * @return Execution status
+ */
+int main(int argc, char *argv[]) {
+    settings_t settings = {1000000, DIST_UNIFORM, 0, 120, "abc", 0.5, 1};
+    for (int i = 1; i < argc; i++) {
+        int status = NO_ERROR;
+        unsigned long seed;
+        if (strcmp(argv[i], "--lines") == 0 && i + 1 < argc) {
+            status = strToULong(argv[++i], &settings.lines);
+        } else if (strcmp(argv[i], "--fixed") == 0 && i + 1 < argc) {
+            settings.distribution = DIST_FIXED;
+            status = strToULong(argv[++i], &settings.minimum);
+        } else if (strcmp(argv[i], "--uniform") == 0 && i + 2 < argc) {
+            settings.distribution = DIST_UNIFORM;
+            status = strToULong(argv[i + 1], &settings.minimum) || strToULong(argv[i + 2], &settings.maximum);
+            i += 2;
+            if (status == NO_ERROR && settings.maximum < settings.minimum) {
+                fprintf(stderr, "Invalid lengths, expected MIN <= MAX.\n");
+                status = ARGUMENT_ERROR;
+            }
+        } else if (strcmp(argv[i], "--exponential") == 0 && i + 2 < argc) {
+            settings.distribution = DIST_EXPONENTIAL;
+            status = strToULong(argv[i + 1], &settings.minimum) || strToULong(argv[i + 2], &settings.maximum);
+            i += 2;
+        } else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc) {
+            settings.pattern = argv[++i];
+        } else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            status = strToDouble(argv[++i], &settings.density);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            status = strToULong(argv[++i], &seed);
+            settings.seed = seed;
+        } else {
+            printUsage();
+            return (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) ? NO_ERROR : ARGUMENT_ERROR;
+        }
+        if (status != NO_ERROR) {
+            return (status == ARGUMENT_ERROR) ? ARGUMENT_ERROR : CONVERSION_ERROR;
+        }
+    }
+    return generate(&settings);
+}
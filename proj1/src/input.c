@@ -0,0 +1,415 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Input layer. The input is read in large blocks (or mapped into the memory if
+ * it is a regular file) and lines are handed out as views into the buffer, so
+ * lines may have an arbitrary length and they are never copied. New lines are
+ * found by memchr, which is vectorized by the C library. Lines skipped until a
+ * pattern appears are searched in the whole buffer at once and handed out as
+ * one block. Lines which are skipped or copied as they are (d, n with a count)
+ * are counted in raw blocks by comparing 64 characters at once with SSE2.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "input.h"
+#include "proj1.h"
+
+/**
+ * Maps the rest of the regular file into the memory
+ * @param reader Reader
+ * @return Has the file been mapped?
+ */
+static bool readerMap(reader_t *reader) {
+    struct stat info;
+    if (fstat(reader->fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return false;
+    }
+    off_t offset = lseek(reader->fd, 0, SEEK_CUR);
+    if (offset < 0 || info.st_size <= offset) {
+        return false;
+    }
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    posix_madvise(data, (size_t) info.st_size, POSIX_MADV_SEQUENTIAL);
+    reader->data = data;
+    reader->length = reader->capacity = (size_t) info.st_size;
+    reader->position = reader->scanned = (size_t) offset;
+    reader->mapped = true;
+    reader->end = true;
+    return true;
+}
+
+/**
+ * Opens the reader of the file descriptor
+ * @param reader Reader
+ * @param fd Input file descriptor
+ * @return Execution status
+ */
+int readerOpen(reader_t *reader, int fd) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = fd;
+    if (readerMap(reader)) {
+        return NO_ERROR;
+    }
+    reader->data = malloc(READER_BLOCK_SIZE);
+    if (reader->data == NULL) {
+        return BUFFER_ERROR;
+    }
+    reader->capacity = READER_BLOCK_SIZE;
+    return NO_ERROR;
+}
+
+/**
+ * Opens the reader of the input in the memory, the input is not copied
+ * @param reader Reader
+ * @param data Input, must outlive the reader
+ * @param length Length of the input
+ */
+void readerOpenMemory(reader_t *reader, const char *data, size_t length) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fd = -1;
+    reader->data = (char *) data;
+    reader->length = reader->capacity = length;
+    reader->borrowed = true;
+    reader->end = true;
+}
+
+/**
+ * Reads the next block of the input, the unread part of the buffer is moved
+ * to its beginning and the buffer grows if a line does not fit into it
+ * @param reader Reader
+ * @return Execution status
+ */
+static int readerFill(reader_t *reader) {
+    if (reader->position > 0) {
+        memmove(reader->data, reader->data + reader->position, reader->length - reader->position);
+        reader->offset += reader->position;
+        reader->length -= reader->position;
+        reader->scanned -= reader->position;
+        reader->position = 0;
+    }
+    if (reader->capacity - reader->length < READER_BLOCK_SIZE / 2) {
+        char *data = realloc(reader->data, 2 * reader->capacity);
+        if (data == NULL) {
+            return BUFFER_ERROR;
+        }
+        reader->data = data;
+        reader->capacity *= 2;
+    }
+    ssize_t count;
+    do {
+        count = read(reader->fd, reader->data + reader->length, reader->capacity - reader->length);
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) {
+        return INPUT_READ_ERROR;
+    }
+    if (count == 0) {
+        reader->end = true;
+    }
+    reader->length += (size_t) count;
+    return NO_ERROR;
+}
+
+/**
+ * Reads the next line
+ * @param reader Reader
+ * @param line View of the line, valid until the next line is read
+ * @return Execution status
+ */
+int readerNext(reader_t *reader, line_t *line) {
+    for (;;) {
+        char *start = reader->data + reader->position;
+        char *newLine = memchr(reader->data + reader->scanned, '\n', reader->length - reader->scanned);
+        if (newLine != NULL) {
+            line->data = start;
+            line->length = (size_t) (newLine - start);
+            reader->position = reader->scanned = (size_t) (newLine - reader->data) + 1;
+            return NO_ERROR;
+        }
+        reader->scanned = reader->length;
+        if (reader->end) {
+            if (reader->position == reader->length) {
+                return FILE_END;
+            }
+            line->data = start;
+            line->length = reader->length - reader->position;
+            reader->position = reader->length;
+            return NO_ERROR;
+        }
+        int status = readerFill(reader);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+}
+
+/**
+ * Finds the end of the COUNT-th line of the block
+ * @param data Block
+ * @param length Length of the block
+ * @param count Count of lines to find, decreased by the count of found lines
+ * @return Position behind the new line of the last found line, 0 if no line was found
+ */
+static size_t countLines(const char *data, size_t length, size_t *count) {
+    size_t remaining = *count;
+    size_t end = 0;
+    size_t i = 0;
+#ifdef __SSE2__
+    const __m128i newLine = _mm_set1_epi8('\n');
+    while (remaining > 0 && i + 64 <= length) {
+        uint64_t mask = 0;
+        for (int j = 0; j < 4; j++) {
+            __m128i block = _mm_loadu_si128((const __m128i *) (data + i + 16 * j));
+            mask |= (uint64_t) (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(block, newLine)) << (16 * j);
+        }
+        if (mask == 0) {
+            // Long lines are skipped by memchr, which uses the widest vectors
+            const char *newLinePosition = memchr(data + i, '\n', length - i);
+            i = (newLinePosition == NULL) ? length : (size_t) (newLinePosition - data);
+            continue;
+        }
+        size_t found = (size_t) __builtin_popcountll(mask);
+        if (found < remaining) {
+            remaining -= found;
+            end = i + 64 - (size_t) __builtin_clzll(mask);
+            i += 64;
+            continue;
+        }
+        while (--remaining > 0) {
+            mask &= mask - 1;
+        }
+        end = i + (size_t) __builtin_ctzll(mask) + 1;
+    }
+#endif
+    while (remaining > 0 && i < length) {
+        const char *newLinePosition = memchr(data + i, '\n', length - i);
+        if (newLinePosition == NULL) {
+            break;
+        }
+        i = end = (size_t) (newLinePosition - data) + 1;
+        remaining--;
+    }
+    *count = remaining;
+    return end;
+}
+
+/**
+ * Reads the block of at most COUNT lines without splitting it into lines
+ * The block ends with the last complete buffered line, so the caller repeats
+ * the call until it gets all lines.
+ * @param reader Reader
+ * @param count Maximal count of lines
+ * @param data First character of the block, valid until the next read
+ * @param length Length of the block
+ * @param lines Count of lines in the block
+ * @return Execution status
+ */
+int readerLines(reader_t *reader, size_t count, const char **data, size_t *length, size_t *lines) {
+    for (;;) {
+        size_t available = reader->length - reader->position;
+        size_t remaining = count;
+        size_t end = countLines(reader->data + reader->position, available, &remaining);
+        if (remaining > 0 && reader->end && end < available) {
+            // The last line of the input has no new line
+            end = available;
+            remaining--;
+        }
+        if (end > 0) {
+            *data = reader->data + reader->position;
+            *length = end;
+            *lines = count - remaining;
+            reader->position = reader->scanned = reader->position + end;
+            return NO_ERROR;
+        }
+        if (reader->end) {
+            return FILE_END;
+        }
+        int status = readerFill(reader);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+}
+
+/**
+ * Reads the next line without consuming it
+ * @param reader Reader
+ * @param line View of the line, valid until the next line is read
+ * @return Execution status
+ */
+int readerPeek(reader_t *reader, line_t *line) {
+    int status = readerNext(reader, line);
+    if (status == NO_ERROR) {
+        reader->position = reader->scanned = (size_t) (line->data - reader->data);
+    }
+    return status;
+}
+
+/**
+ * Finds the start of the line containing the position
+ * @param reader Reader
+ * @param position Position in the buffered input
+ * @return Start of the line, not before the next unread line
+ */
+static size_t lineStart(const reader_t *reader, size_t position) {
+    while (position > reader->position && reader->data[position - 1] != '\n') {
+        position--;
+    }
+    return position;
+}
+
+/**
+ * Reads the block of complete lines which precede the next line containing the pattern
+ * The whole buffered input is searched at once. If the pattern is not there,
+ * the block ends with the last complete buffered line, so the caller repeats
+ * the call until the pattern is found.
+ * @param reader Reader
+ * @param searcher Searcher of the pattern
+ * @param data First character of the block, valid until the next read
+ * @param length Length of the block, 0 if the next line contains the pattern
+ * @param found Does the next unread line contain the pattern?
+ * @return Execution status
+ */
+int readerSkip(reader_t *reader, const searcher_t *searcher, const char **data, size_t *length, bool *found) {
+    for (;;) {
+        size_t match = searchFind(searcher, reader->data, reader->length, reader->position);
+        size_t end;
+        if (match != SEARCH_NONE) {
+            end = lineStart(reader, match);
+        } else if (reader->end) {
+            if (reader->position == reader->length) {
+                return FILE_END;
+            }
+            end = reader->length;
+        } else {
+            end = lineStart(reader, reader->length);
+        }
+        *found = (match != SEARCH_NONE);
+        if (*found || end > reader->position) {
+            *data = reader->data + reader->position;
+            *length = end - reader->position;
+            reader->position = reader->scanned = end;
+            return NO_ERROR;
+        }
+        int status = readerFill(reader);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+}
+
+/**
+ * Reads the next block of the unread input regardless of lines
+ * @param reader Reader
+ * @param data First character of the block, valid until the next read
+ * @param length Length of the block
+ * @return Execution status
+ */
+int readerBlock(reader_t *reader, const char **data, size_t *length) {
+    if (reader->position == reader->length) {
+        if (reader->end) {
+            return FILE_END;
+        }
+        reader->offset += reader->position;
+        reader->length = reader->position = reader->scanned = 0;
+        int status = readerFill(reader);
+        if (status != NO_ERROR) {
+            return status;
+        }
+        if (reader->length == 0) {
+            return FILE_END;
+        }
+    }
+    *data = reader->data + reader->position;
+    *length = reader->length - reader->position;
+    reader->position = reader->scanned = reader->length;
+    return NO_ERROR;
+}
+
+/**
+ * Reads the next chunk of complete lines, the chunk is at least SIZE bytes
+ * long unless the input ends and it ends just behind a new line (or with the
+ * end of the input)
+ * @param reader Reader
+ * @param size Preferred size of the chunk
+ * @param data First character of the chunk, valid until the next read
+ * @param length Length of the chunk
+ * @return Execution status
+ */
+int readerChunk(reader_t *reader, size_t size, const char **data, size_t *length) {
+    for (;;) {
+        size_t available = reader->length - reader->position;
+        if (available >= size || reader->end) {
+            if (available == 0) {
+                return FILE_END;
+            }
+            size_t from = reader->position + ((available < size) ? available : size) - 1;
+            char *newLine = memchr(reader->data + from, '\n', reader->length - from);
+            if (newLine != NULL || reader->end) {
+                size_t end = (newLine == NULL) ? reader->length : (size_t) (newLine - reader->data) + 1;
+                *data = reader->data + reader->position;
+                *length = end - reader->position;
+                reader->position = reader->scanned = end;
+                return NO_ERROR;
+            }
+            // The last line of the chunk continues behind the buffered input
+            size = available + 1;
+        }
+        int status = readerFill(reader);
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+}
+
+/**
+ * Gets the count of read bytes
+ * @param reader Reader
+ * @return Offset of the next unread line in the input
+ */
+size_t readerTell(const reader_t *reader) {
+    return reader->offset + reader->position;
+}
+
+/**
+ * Closes the reader, the file descriptor and the borrowed input are kept
+ * @param reader Reader
+ */
+void readerClose(reader_t *reader) {
+    if (reader->mapped) {
+        munmap(reader->data, reader->capacity);
+    } else if (!reader->borrowed) {
+        free(reader->data);
+    }
+    reader->data = NULL;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "search.h"
+
+/// Size of the block read from the input at once
+#define READER_BLOCK_SIZE (1 << 16)
+
+/**
+ * View of one input line without the new line character
+ */
+typedef struct {
+    /// First character of the line, valid until the next line is read
+    const char *data;
+    /// Length of the line
+    size_t length;
+} line_t;
+
+/**
+ * Buffered reader of input lines
+ */
+typedef struct {
+    /// Input file descriptor
+    int fd;
+    /// Buffered or memory mapped input
+    char *data;
+    /// Length of the valid input
+    size_t length;
+    /// Capacity of the buffer
+    size_t capacity;
+    /// Offset of the buffer in the input
+    size_t offset;
+    /// Position of the next unread line
+    size_t position;
+    /// Position where the search for the next new line continues
+    size_t scanned;
+    /// Is the input mapped into the memory?
+    bool mapped;
+    /// Is the input a span of the memory owned by the caller?
+    bool borrowed;
+    /// Has the whole input been read?
+    bool end;
+} reader_t;
+
+int readerOpen(reader_t *reader, int fd);
+
+void readerOpenMemory(reader_t *reader, const char *data, size_t length);
+
+int readerNext(reader_t *reader, line_t *line);
+
+int readerPeek(reader_t *reader, line_t *line);
+
+int readerSkip(reader_t *reader, const searcher_t *searcher, const char **data, size_t *length, bool *found);
+
+int readerLines(reader_t *reader, size_t count, const char **data, size_t *length, size_t *lines);
+
+int readerBlock(reader_t *reader, const char **data, size_t *length);
+
+int readerChunk(reader_t *reader, size_t size, const char **data, size_t *length);
+
+size_t readerTell(const reader_t *reader);
+
+void readerClose(reader_t *reader);
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Analysis of programs which transform every line independently. Such a
+ * program is reduced into the texts printed around each line and the list of
+ * substitutions, so lines may be processed in one fused loop (or in any order
+ * by more threads) without dispatching the commands for every line.
+ */
+
+#include <string.h>
+
+#include "loop.h"
+#include "proj1.h"
+
+/**
+ * Reduces the program into the per-line transformation
+ * @param program Compiled program
+ * @param loop Per-line transformation, valid while the program exists
+ * @return Is the program a per-line transformation?
+ */
+bool loopAnalyse(const program_t *program, loop_t *loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->regexpCount = program->regexpCount;
+    size_t count = program->count;
+    if (count < 2 || program->instructions[count - 1].cmd != CMD_GOTO || program->instructions[count - 1].count != 0) {
+        return false;
+    }
+    bool next = false;
+    bool newLine = true;
+    int status = NO_ERROR;
+    for (size_t i = 0; i + 1 < count && status == NO_ERROR; i++) {
+        const instruction_t *instruction = &program->instructions[i];
+        if (next && instruction->cmd != CMD_INSERT) {
+            status = UNKNOWN_COMMAND;
+            break;
+        }
+        switch (instruction->cmd) {
+            case CMD_INSERT:
+                status = bufferAppend(next ? &loop->suffix : &loop->prefix, instruction->text,
+                                      instruction->textLength);
+                if (status == NO_ERROR) {
+                    status = bufferAppend(next ? &loop->suffix : &loop->prefix, "\n", 1);
+                }
+                break;
+            case CMD_APPEND:
+                status = bufferAppend(&loop->after, instruction->text, instruction->textLength);
+                break;
+            case CMD_BEFORE:
+                status = bufferPrepend(&loop->before, instruction->text, instruction->textLength);
+                break;
+            case CMD_EOL:
+                status = bufferAppend(&loop->after, "\n", 1);
+                break;
+            case CMD_REMOVE:
+                newLine = false;
+                break;
+            case CMD_SUBSTITUTE:
+            case CMD_SUBSTITUTE_ALL:
+                if (loop->substituteCmds.count == COMMAND_SIZE) {
+                    status = UNKNOWN_COMMAND;
+                    break;
+                }
+                loop->substituteCmds.cmds[loop->substituteCmds.count++] = instruction;
+                break;
+            case CMD_NEXT:
+                next = (instruction->count == 1);
+                status = next ? NO_ERROR : UNKNOWN_COMMAND;
+                break;
+            default:
+                status = UNKNOWN_COMMAND;
+                break;
+        }
+    }
+    if (status == NO_ERROR && next && newLine) {
+        status = bufferAppend(&loop->after, "\n", 1);
+    }
+    if (status != NO_ERROR || !next) {
+        loopFree(loop);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Appends the transformed line to the output
+ * @param loop Per-line transformation
+ * @param line Line without the new line
+ * @param length Length of the line
+ * @param sequential Apply substitutions one after another?
+ * @param context State of substitutions
+ * @param scratch Buffer for the line before substitutions
+ * @param output Output buffer
+ * @return Execution status
+ */
+int loopLine(const loop_t *loop, const char *line, size_t length, bool sequential, substituteContext_t *context,
+             buffer_t *scratch, buffer_t *output) {
+    if (bufferAppend(output, loop->prefix.data, loop->prefix.length)) {
+        return BUFFER_ERROR;
+    }
+    if (loop->substituteCmds.count == 0) {
+        if (bufferAppend(output, loop->before.data, loop->before.length) || bufferAppend(output, line, length) ||
+            bufferAppend(output, loop->after.data, loop->after.length)) {
+            return BUFFER_ERROR;
+        }
+    } else {
+        bufferClear(scratch);
+        if (bufferAppend(scratch, loop->before.data, loop->before.length) || bufferAppend(scratch, line, length) ||
+            bufferAppend(scratch, loop->after.data, loop->after.length)) {
+            return BUFFER_ERROR;
+        }
+        int status;
+        if (sequential) {
+            status = substituteApplySequential(&loop->substituteCmds, context, scratch);
+            if (status == NO_ERROR) {
+                status = bufferAppend(output, scratch->data, scratch->length);
+            }
+        } else {
+            status = substituteApply(&loop->substituteCmds, context, scratch->data, scratch->length, output);
+        }
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+    return bufferAppend(output, loop->suffix.data, loop->suffix.length);
+}
+
+/**
+ * Transforms all input lines by the per-line transformation in one thread
+ * @param loop Per-line transformation
+ * @param context State of substitutions of the calling thread
+ * @param reader Reader of the input
+ * @param writer Writer of the output
+ * @param sequential Apply substitutions one after another?
+ * @return Execution status
+ */
+int loopExecute(const loop_t *loop, substituteContext_t *context, reader_t *reader, writer_t *writer, bool sequential) {
+    buffer_t scratch = {NULL, 0, 0};
+    buffer_t output = {NULL, 0, 0};
+    line_t line;
+    int status;
+    while ((status = readerNext(reader, &line)) == NO_ERROR) {
+        if (loop->substituteCmds.count == 0) {
+            struct iovec fragments[] = {
+                {loop->prefix.data, loop->prefix.length},
+                {loop->before.data, loop->before.length},
+                {(void *) line.data, line.length},
+                {loop->after.data, loop->after.length},
+                {loop->suffix.data, loop->suffix.length},
+            };
+            status = writerWriteFragments(writer, fragments, 5);
+        } else {
+            bufferClear(&output);
+            status = loopLine(loop, line.data, line.length, sequential, context, &scratch, &output);
+            if (status == NO_ERROR) {
+                status = writerWrite(writer, output.data, output.length);
+            }
+        }
+        if (status != NO_ERROR) {
+            break;
+        }
+    }
+    bufferFree(&scratch);
+    bufferFree(&output);
+    if (status == FILE_END) {
+        // The last iteration prints its i commands before n finds the end of the input
+        status = writerWrite(writer, loop->prefix.data, loop->prefix.length);
+    }
+    return status;
+}
+
+/**
+ * Frees the per-line transformation
+ * @param loop Per-line transformation
+ */
+void loopFree(loop_t *loop) {
+    bufferFree(&loop->prefix);
+    bufferFree(&loop->before);
+    bufferFree(&loop->after);
+    bufferFree(&loop->suffix);
+    loop->substituteCmds.count = 0;
+}
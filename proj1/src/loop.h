@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "buffer.h"
+#include "input.h"
+#include "output.h"
+#include "program.h"
+#include "substitute.h"
+
+/**
+ * Program which repeats the same transformation of every input line
+ *
+ * The program has the form "P n g1" or "P n I g1", where P consists only of
+ * the commands i, a, b, e, r, s and S and I consists only of the command i.
+ * Every iteration starts in the same state and consumes exactly one line, so
+ * the output of a line depends only on the line itself.
+ */
+typedef struct {
+    /// Texts of the i commands before n
+    buffer_t prefix;
+    /// Text printed before the line
+    buffer_t before;
+    /// Text printed after the line, including the new line
+    buffer_t after;
+    /// Texts of the i commands after n
+    buffer_t suffix;
+    /// Substitutions applied to the line
+    substituteCmds_t substituteCmds;
+    /// Count of regular expressions in the program
+    size_t regexpCount;
+} loop_t;
+
+bool loopAnalyse(const program_t *program, loop_t *loop);
+
+int loopLine(const loop_t *loop, const char *line, size_t length, bool sequential, substituteContext_t *context,
+             buffer_t *scratch, buffer_t *output);
+
+int loopExecute(const loop_t *loop, substituteContext_t *context, reader_t *reader, writer_t *writer, bool sequential);
+
+void loopFree(loop_t *loop);
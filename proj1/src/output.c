@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Output layer. Small pieces of the output are collected in a large private
+ * buffer, long fragments (the line views from the input buffer and the texts
+ * of the commands) are written by writev together with the buffered output,
+ * so they are never concatenated. The rest of the input is forwarded in whole
+ * blocks, a memory mapped input file is copied by the kernel. Embedding
+ * callers may pass a sink instead of the file descriptor, it receives the same
+ * fragments one by one. Such writers serve records rather than files, so their
+ * buffer is small and may be handed to the next execution.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include "output.h"
+#include "proj1.h"
+
+/// Count of bytes copied by the kernel at once
+#define WRITER_COPY_SIZE (1 << 30)
+
+/**
+ * Writes all fragments
+ * @param writer Writer
+ * @param fragments Fragments, modified by partial writes
+ * @param count Count of fragments
+ * @return Execution status
+ */
+static int writeFragments(const writer_t *writer, struct iovec *fragments, int count) {
+    if (writer->sink != NULL) {
+        for (int i = 0; i < count; i++) {
+            if (fragments[i].iov_len > 0 &&
+                writer->sink(fragments[i].iov_base, fragments[i].iov_len, writer->argument) != 0) {
+                return OUTPUT_WRITE_ERROR;
+            }
+        }
+        return NO_ERROR;
+    }
+    while (count > 0) {
+        ssize_t written = writev(writer->fd, fragments, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return OUTPUT_WRITE_ERROR;
+        }
+        while (count > 0 && (size_t) written >= fragments->iov_len) {
+            written -= (ssize_t) fragments->iov_len;
+            fragments++;
+            count--;
+        }
+        if (count > 0) {
+            fragments->iov_base = (char *) fragments->iov_base + written;
+            fragments->iov_len -= (size_t) written;
+        }
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Opens the writer of the file descriptor
+ * @param writer Writer
+ * @param fd Output file descriptor
+ * @return Execution status
+ */
+int writerOpen(writer_t *writer, int fd) {
+    writer->fd = fd;
+    writer->sink = NULL;
+    writer->argument = NULL;
+    writer->length = 0;
+    writer->total = 0;
+    writer->capacity = WRITER_BUFFER_SIZE;
+    writer->data = malloc(writer->capacity);
+    return (writer->data == NULL) ? BUFFER_ERROR : NO_ERROR;
+}
+
+/**
+ * Opens the writer into the consumer of the output
+ * @param writer Writer
+ * @param sink Consumer of the output
+ * @param argument Argument of the consumer
+ * @return Execution status
+ */
+int writerOpenSink(writer_t *writer, writerSink_t sink, void *argument) {
+    writer->fd = -1;
+    writer->sink = sink;
+    writer->argument = argument;
+    writer->length = 0;
+    writer->total = 0;
+    writer->capacity = WRITER_SINK_SIZE;
+    writer->data = malloc(writer->capacity);
+    return (writer->data == NULL) ? BUFFER_ERROR : NO_ERROR;
+}
+
+/**
+ * Redirects the writer opened by writerOpenSink into another consumer, so its buffer serves the next execution
+ * The buffered output is dropped and the count of written bytes starts again.
+ * @param writer Writer
+ * @param sink Consumer of the output
+ * @param argument Argument of the consumer
+ */
+void writerSetSink(writer_t *writer, writerSink_t sink, void *argument) {
+    writer->sink = sink;
+    writer->argument = argument;
+    writer->length = 0;
+    writer->total = 0;
+}
+
+/**
+ * Writes data
+ * @param writer Writer
+ * @param data Data to write
+ * @param length Length of the data
+ * @return Execution status
+ */
+int writerWrite(writer_t *writer, const char *data, size_t length) {
+    struct iovec fragment = {(void *) data, length};
+    return writerWriteFragments(writer, &fragment, 1);
+}
+
+/**
+ * Writes fragments of the output in the order
+ * @param writer Writer
+ * @param fragments Fragments
+ * @param count Count of fragments
+ * @return Execution status
+ */
+int writerWriteFragments(writer_t *writer, const struct iovec *fragments, size_t count) {
+    for (; count > WRITER_FRAGMENTS; fragments += WRITER_FRAGMENTS, count -= WRITER_FRAGMENTS) {
+        if (writerWriteFragments(writer, fragments, WRITER_FRAGMENTS) != NO_ERROR) {
+            return OUTPUT_WRITE_ERROR;
+        }
+    }
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++) {
+        length += fragments[i].iov_len;
+    }
+    writer->total += length;
+    if (length < WRITER_DIRECT_SIZE && length <= writer->capacity) {
+        if (writer->capacity - writer->length < length && writerFlush(writer) != NO_ERROR) {
+            return OUTPUT_WRITE_ERROR;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (fragments[i].iov_len > 0) {
+                memcpy(writer->data + writer->length, fragments[i].iov_base, fragments[i].iov_len);
+                writer->length += fragments[i].iov_len;
+            }
+        }
+        return NO_ERROR;
+    }
+    struct iovec all[WRITER_FRAGMENTS + 1] = {{writer->data, writer->length}};
+    memcpy(all + 1, fragments, count * sizeof(struct iovec));
+    writer->length = 0;
+    return writeFragments(writer, all, (int) count + 1);
+}
+
+/**
+ * Writes the buffered output
+ * @param writer Writer
+ * @return Execution status
+ */
+int writerFlush(writer_t *writer) {
+    struct iovec fragment = {writer->data, writer->length};
+    writer->length = 0;
+    return writeFragments(writer, &fragment, 1);
+}
+
+/**
+ * Lets the kernel copy the part of the input file
+ * @param writer Writer
+ * @param fd Input file descriptor
+ * @param offset Offset of the part
+ * @param length Length of the part
+ * @return Count of copied bytes, the rest must be written by the caller
+ */
+static size_t writerCopyFile(writer_t *writer, int fd, size_t offset, size_t length) {
+    size_t copied = 0;
+#ifdef __linux__
+    off_t position = (off_t) offset;
+    while (copied < length) {
+        size_t count = length - copied;
+        if (count > WRITER_COPY_SIZE) {
+            count = WRITER_COPY_SIZE;
+        }
+        ssize_t result = copy_file_range(fd, &position, writer->fd, NULL, count, 0);
+        if (result <= 0) {
+            result = sendfile(writer->fd, fd, &position, count);
+        }
+        if (result <= 0) {
+            if (result < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        copied += (size_t) result;
+    }
+#else
+    (void) writer;
+    (void) fd;
+    (void) offset;
+    (void) length;
+#endif
+    return copied;
+}
+
+/**
+ * Forwards the rest of the input, every line ends with the new line
+ * @param writer Writer
+ * @param reader Reader of the input
+ * @param lines Incremented by the count of forwarded lines, NULL to skip counting them
+ * @return Execution status
+ */
+int writerPassthrough(writer_t *writer, reader_t *reader, size_t *lines) {
+    size_t offset = reader->position;
+    bool mapped = reader->mapped;
+    char lastCharacter = '\n';
+    const char *data;
+    size_t length;
+    int status;
+    while ((status = readerBlock(reader, &data, &length)) == NO_ERROR) {
+        lastCharacter = data[length - 1];
+        if (lines != NULL) {
+            for (const char *newLine = data; (newLine = memchr(newLine, '\n', data + length - newLine)) != NULL;
+                 newLine++) {
+                (*lines)++;
+            }
+        }
+        size_t copied = 0;
+        if (mapped) {
+            if (writerFlush(writer) != NO_ERROR) {
+                return OUTPUT_WRITE_ERROR;
+            }
+            copied = writerCopyFile(writer, reader->fd, offset, length);
+            writer->total += copied;
+        }
+        if (writerWrite(writer, data + copied, length - copied) != NO_ERROR) {
+            return OUTPUT_WRITE_ERROR;
+        }
+    }
+    if (status != FILE_END) {
+        return status;
+    }
+    if (lastCharacter != '\n') {
+        if (lines != NULL) {
+            (*lines)++;
+        }
+        return writerWrite(writer, "\n", 1);
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Closes the writer, the buffered output is dropped and the file descriptor is kept open
+ * @param writer Writer
+ */
+void writerClose(writer_t *writer) {
+    free(writer->data);
+    writer->data = NULL;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/uio.h>
+
+#include "input.h"
+
+/// Size of the private output buffer
+#define WRITER_BUFFER_SIZE (1 << 18)
+/// Size of the private buffer of the writer into a consumer, enough for a few records
+#define WRITER_SINK_SIZE (1 << 12)
+/// Fragments at least this long are written directly instead of being copied into the buffer
+#define WRITER_DIRECT_SIZE (1 << 14)
+/// Count of fragments written by one system call
+#define WRITER_FRAGMENTS 8
+
+/**
+ * Consumer of the output written into the memory
+ * @param data Piece of the output, valid only during the call
+ * @param length Length of the piece
+ * @param argument Argument of the consumer
+ * @return 0 on success, anything else stops the execution
+ */
+typedef int (*writerSink_t)(const char *data, size_t length, void *argument);
+
+/**
+ * Buffered writer of the output
+ */
+typedef struct {
+    /// Output file descriptor
+    int fd;
+    /// Consumer of the output, NULL if the output is written into the file descriptor
+    writerSink_t sink;
+    /// Argument of the consumer
+    void *argument;
+    /// Private buffer
+    char *data;
+    /// Capacity of the private buffer
+    size_t capacity;
+    /// Length of the buffered output
+    size_t length;
+    /// Count of bytes written since the writer was opened
+    size_t total;
+} writer_t;
+
+int writerOpen(writer_t *writer, int fd);
+
+int writerOpenSink(writer_t *writer, writerSink_t sink, void *argument);
+
+void writerSetSink(writer_t *writer, writerSink_t sink, void *argument);
+
+int writerWrite(writer_t *writer, const char *data, size_t length);
+
+int writerWriteFragments(writer_t *writer, const struct iovec *fragments, size_t count);
+
+int writerFlush(writer_t *writer);
+
+int writerPassthrough(writer_t *writer, reader_t *reader, size_t *lines);
+
+void writerClose(writer_t *writer);
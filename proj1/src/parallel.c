@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Parallel execution of per-line transformations. Chunks of complete lines
+ * go through the shared ordered ring: every worker keeps its own state of
+ * substitutions and transforms whole chunks, the output is written in the
+ * input order. Chunks of a memory mapped or borrowed input are not copied.
+ */
+
+#include <string.h>
+
+#include "parallel.h"
+#include "proj1.h"
+#include "ring.h"
+
+/**
+ * Chunk of complete lines and its transformation
+ */
+typedef struct {
+    /// Input lines
+    const char *input;
+    /// Length of the input lines
+    size_t inputLength;
+    /// Copy of the input lines if the input is neither memory mapped nor borrowed
+    buffer_t copy;
+    /// Transformed lines
+    buffer_t output;
+    /// Buffer for lines before substitutions
+    buffer_t scratch;
+} chunk_t;
+
+/**
+ * Argument of callbacks of the ring
+ */
+typedef struct {
+    /// Per-line transformation
+    const loop_t *loop;
+    /// Apply substitutions one after another?
+    bool sequential;
+    /// Reader of the input
+    reader_t *reader;
+    /// Writer of the output
+    writer_t *writer;
+} parallel_t;
+
+/**
+ * Takes the next chunk of complete lines from the reader
+ * @param argument Parallel execution
+ * @param slot Chunk to fill
+ * @param end Set at the end of the input
+ * @return Execution status
+ */
+static int readChunk(void *argument, void *slot, bool *end) {
+    parallel_t *parallel = argument;
+    chunk_t *chunk = slot;
+    const char *data;
+    size_t length;
+    int status = readerChunk(parallel->reader, PARALLEL_CHUNK_SIZE, &data, &length);
+    if (status == FILE_END) {
+        *end = true;
+        return NO_ERROR;
+    }
+    if (status != NO_ERROR) {
+        return status;
+    }
+    if (!parallel->reader->mapped && !parallel->reader->borrowed) {
+        bufferClear(&chunk->copy);
+        if (bufferAppend(&chunk->copy, data, length) != NO_ERROR) {
+            return BUFFER_ERROR;
+        }
+        data = chunk->copy.data;
+    }
+    chunk->input = data;
+    chunk->inputLength = length;
+    return NO_ERROR;
+}
+
+/**
+ * Transforms all lines of the chunk into its output buffer
+ * @param argument Parallel execution
+ * @param local State of substitutions of the worker
+ * @param slot Chunk
+ * @return Execution status
+ */
+static int transformChunk(void *argument, void *local, void *slot) {
+    const parallel_t *parallel = argument;
+    chunk_t *chunk = slot;
+    const char *line = chunk->input;
+    const char *end = chunk->input + chunk->inputLength;
+    bufferClear(&chunk->output);
+    if (bufferReserve(&chunk->output, chunk->inputLength + chunk->inputLength / 8) != NO_ERROR) {
+        return BUFFER_ERROR;
+    }
+    while (line < end) {
+        const char *newLine = memchr(line, '\n', (size_t) (end - line));
+        if (newLine == NULL) {
+            newLine = end;
+        }
+        int status = loopLine(parallel->loop, line, (size_t) (newLine - line), parallel->sequential, local,
+                              &chunk->scratch, &chunk->output);
+        if (status != NO_ERROR) {
+            return status;
+        }
+        line = newLine + 1;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Writes the transformed lines of the chunk
+ * @param argument Parallel execution
+ * @param slot Chunk
+ * @return Execution status
+ */
+static int writeChunk(void *argument, void *slot) {
+    const parallel_t *parallel = argument;
+    const chunk_t *chunk = slot;
+    return writerWrite(parallel->writer, chunk->output.data, chunk->output.length);
+}
+
+/**
+ * Opens the state of substitutions of one worker
+ * @param argument Parallel execution
+ * @param local State of substitutions
+ * @return Execution status
+ */
+static int openContext(void *argument, void *local) {
+    const parallel_t *parallel = argument;
+    return substituteContextOpen(local, parallel->loop->regexpCount);
+}
+
+/**
+ * Closes the state of substitutions of one worker
+ * @param local State of substitutions
+ */
+static void closeContext(void *local) {
+    substituteContextClose(local);
+}
+
+/**
+ * Frees buffers of the chunk
+ * @param slot Chunk
+ */
+static void freeChunk(void *slot) {
+    chunk_t *chunk = slot;
+    bufferFree(&chunk->copy);
+    bufferFree(&chunk->output);
+    bufferFree(&chunk->scratch);
+}
+
+/**
+ * Transforms all input lines by the per-line transformation and writes them in the input order
+ * @param loop Per-line transformation
+ * @param reader Reader of the input
+ * @param writer Writer of the output
+ * @param threads Count of worker threads, at most RING_MAX_THREADS are started
+ * @param sequential Apply substitutions one after another?
+ * @return Execution status
+ */
+int parallelExecute(const loop_t *loop, reader_t *reader, writer_t *writer, unsigned int threads, bool sequential) {
+    parallel_t parallel = {loop, sequential, reader, writer};
+    ring_t ring = {sizeof(chunk_t), sizeof(substituteContext_t), &parallel, BUFFER_ERROR, BUFFER_ERROR,
+                   readChunk, transformChunk, writeChunk, openContext, closeContext, freeChunk};
+    int status = ringExecute(&ring, (threads > 0) ? threads : 1);
+    if (status == NO_ERROR) {
+        // The last iteration prints its i commands before n finds the end of the input
+        status = writerWrite(writer, loop->prefix.data, loop->prefix.length);
+    }
+    return status;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "input.h"
+#include "loop.h"
+#include "output.h"
+
+/// Preferred size of the input chunk processed by one thread
+#define PARALLEL_CHUNK_SIZE (1 << 22)
+int parallelExecute(const loop_t *loop, reader_t *reader, writer_t *writer, unsigned int threads, bool sequential);
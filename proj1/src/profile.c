@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Per-command profile of the script execution. The interpreter samples the
+ * monotonic clock and the input and output byte counters around every
+ * command only if the profile is enabled, so a disabled profile costs one
+ * branch per command.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "profile.h"
+#include "proj1.h"
+
+/**
+ * Opens the profile with zero counters
+ * @param profile Profile
+ * @param count Count of instructions
+ * @param json Print the report as JSON?
+ * @return Execution status
+ */
+int profileOpen(profile_t *profile, size_t count, bool json) {
+    profile->entries = calloc(count + 1, sizeof(profileEntry_t));
+    profile->count = count;
+    profile->rest = (profileEntry_t) {0, 0, 0, 0};
+    profile->lines = 0;
+    profile->json = json;
+    profile->start = profileClock();
+    return (profile->entries == NULL) ? BUFFER_ERROR : NO_ERROR;
+}
+
+/**
+ * Reads the monotonic clock
+ * @return Time in nanoseconds
+ */
+uint64_t profileClock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * Adds one execution to the counters
+ * @param entry Counters of the command
+ * @param start Time when the execution started
+ * @param bytesIn Count of read input bytes
+ * @param bytesOut Count of written output bytes
+ */
+void profileRecord(profileEntry_t *entry, uint64_t start, size_t bytesIn, size_t bytesOut) {
+    entry->count++;
+    entry->time += profileClock() - start;
+    entry->bytesIn += bytesIn;
+    entry->bytesOut += bytesOut;
+}
+
+/**
+ * Prints counters of one command as a text row
+ * @param stream Output stream
+ * @param line Line of the command
+ * @param name Name of the command
+ * @param entry Counters of the command
+ */
+static void reportRow(FILE *stream, const char *line, const char *name, const profileEntry_t *entry) {
+    fprintf(stream, "%6s  %-7s %12zu %12.3f %14zu %14zu\n", line, name, entry->count, entry->time / 1e6,
+            entry->bytesIn, entry->bytesOut);
+}
+
+/**
+ * Prints counters of one command as a JSON object
+ * @param stream Output stream
+ * @param line Line of the command, 0 for the rest of the input
+ * @param name Name of the command
+ * @param entry Counters of the command
+ */
+static void reportObject(FILE *stream, size_t line, const char *name, const profileEntry_t *entry) {
+    fprintf(stream, "{\"line\": %zu, \"command\": \"%s\", \"count\": %zu, \"time\": %.9f, \"bytesIn\": %zu, "
+                    "\"bytesOut\": %zu}", line, name, entry->count, entry->time / 1e9, entry->bytesIn,
+            entry->bytesOut);
+}
+
+/**
+ * Prints the profile report
+ * @param profile Profile
+ * @param program Profiled program
+ * @param stream Output stream
+ */
+void profileReport(const profile_t *profile, const program_t *program, FILE *stream) {
+    double seconds = (profileClock() - profile->start) / 1e9;
+    profileEntry_t total = profile->rest;
+    for (size_t i = 0; i < profile->count; i++) {
+        total.bytesIn += profile->entries[i].bytesIn;
+        total.bytesOut += profile->entries[i].bytesOut;
+    }
+    double linesPerSecond = (seconds > 0) ? profile->lines / seconds : 0;
+    double megabytesPerSecond = (seconds > 0) ? total.bytesIn / seconds / 1e6 : 0;
+    if (profile->json) {
+        fprintf(stream, "{\"commands\": [");
+        for (size_t i = 0; i < profile->count; i++) {
+            char name[2] = {(char) program->instructions[i].cmd, '\0'};
+            fprintf(stream, (i == 0) ? "\n  " : ",\n  ");
+            reportObject(stream, i + 1, name, &profile->entries[i]);
+        }
+        fprintf(stream, "\n ],\n \"rest\": ");
+        reportObject(stream, 0, "rest", &profile->rest);
+        fprintf(stream, ",\n \"total\": {\"time\": %.9f, \"lines\": %zu, \"bytesIn\": %zu, \"bytesOut\": %zu, "
+                        "\"linesPerSecond\": %.1f, \"megabytesPerSecond\": %.3f}}\n", seconds, profile->lines,
+                total.bytesIn, total.bytesOut, linesPerSecond, megabytesPerSecond);
+        return;
+    }
+    fprintf(stream, "%6s  %-7s %12s %12s %14s %14s\n", "line", "command", "count", "time [ms]", "bytes in",
+            "bytes out");
+    for (size_t i = 0; i < profile->count; i++) {
+        char line[24];
+        char name[2] = {(char) program->instructions[i].cmd, '\0'};
+        snprintf(line, sizeof(line), "%zu", i + 1);
+        reportRow(stream, line, name, &profile->entries[i]);
+    }
+    reportRow(stream, "-", "rest", &profile->rest);
+    fprintf(stream, "total: %.3f s, %zu lines, %zu bytes in, %zu bytes out, %.0f lines/s, %.1f MB/s\n", seconds,
+            profile->lines, total.bytesIn, total.bytesOut, linesPerSecond, megabytesPerSecond);
+}
+
+/**
+ * Closes the profile
+ * @param profile Profile
+ */
+void profileClose(profile_t *profile) {
+    free(profile->entries);
+    profile->entries = NULL;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "program.h"
+
+/**
+ * Counters of one command
+ */
+typedef struct {
+    /// Count of executions
+    size_t count;
+    /// Cumulative time in nanoseconds
+    uint64_t time;
+    /// Count of read input bytes
+    size_t bytesIn;
+    /// Count of written output bytes
+    size_t bytesOut;
+} profileEntry_t;
+
+/**
+ * Execution profile of the program
+ */
+typedef struct {
+    /// Counters of instructions in the script order
+    profileEntry_t *entries;
+    /// Count of instructions
+    size_t count;
+    /// Counters of the rest of the input forwarded after the last command
+    profileEntry_t rest;
+    /// Count of input lines read by commands or forwarded after the last one
+    size_t lines;
+    /// Start of the execution
+    uint64_t start;
+    /// Print the report as JSON?
+    bool json;
+} profile_t;
+
+int profileOpen(profile_t *profile, size_t count, bool json);
+
+uint64_t profileClock(void);
+
+void profileRecord(profileEntry_t *entry, uint64_t start, size_t bytesIn, size_t bytesOut);
+
+void profileReport(const profile_t *profile, const program_t *program, FILE *stream);
+
+void profileClose(profile_t *profile);
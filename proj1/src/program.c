@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Compiler of command scripts. The script is parsed once into an array of
+ * instructions, numeric arguments are converted, substitutions are split into
+ * the pattern and the replacement and goto targets are resolved into
+ * instruction indexes, so the script is validated before any input is read.
+ * Patterns of substitutions are compiled into literal searchers or, if the
+ * patterns are regular expressions, into automata of the regexp module.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input.h"
+#include "program.h"
+#include "proj1.h"
+
+/**
+ * Converts the argument into the count of the command repeats
+ * @param args Argument
+ * @param count Count of the command repeats, 1 if the argument is empty
+ * @return Execution status
+ */
+static int parseCount(const char *args, long int *count) {
+    char *endptr;
+    if (*args == '\0') {
+        *count = 1;
+        return NO_ERROR;
+    }
+    *count = strtol(args, &endptr, 10);
+    if (*endptr != '\0') {
+        fprintf(stderr, "Error in string conversion to int.\n");
+        return CONVERSION_ERROR;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Compiles one command
+ * @param line Command line
+ * @param instruction Compiled command
+ * @param regexps Are patterns of substitutions regular expressions?
+ * @return Execution status
+ */
+static int compileCommand(line_t line, instruction_t *instruction, bool regexps) {
+    memset(instruction, 0, sizeof(*instruction));
+    if (line.length == 0) {
+        fprintf(stderr, "Unknown command: \\n.\n");
+        return UNKNOWN_COMMAND;
+    }
+    instruction->cmd = (enum commands) line.data[0];
+    instruction->textLength = line.length - 1;
+    instruction->text = malloc(instruction->textLength + 1);
+    if (instruction->text == NULL) {
+        return BUFFER_ERROR;
+    }
+    memcpy(instruction->text, line.data + 1, instruction->textLength);
+    instruction->text[instruction->textLength] = '\0';
+    char *args = instruction->text;
+    switch (instruction->cmd) {
+        case CMD_INSERT:
+        case CMD_APPEND:
+        case CMD_BEFORE:
+        case CMD_REMOVE:
+        case CMD_QUIT:
+        case CMD_EOL:
+            return NO_ERROR;
+        case CMD_DELETE:
+        case CMD_NEXT:
+        case CMD_GOTO:
+            return parseCount(args, &instruction->count);
+        case CMD_FIND:
+            searchCompile(&instruction->searcher, instruction->text, instruction->textLength);
+            return NO_ERROR;
+        case CMD_CONDITIONED_GOTO: {
+            char *pattern = strchr(args, ' ');
+            if (pattern == NULL) {
+                fprintf(stderr, "Missing pattern of the conditioned goto: %c%s.\n", instruction->cmd, args);
+                return UNKNOWN_COMMAND;
+            }
+            *pattern = '\0';
+            int status = parseCount(args, &instruction->count);
+            if (status != NO_ERROR) {
+                return status;
+            }
+            instruction->textLength = strlen(pattern + 1);
+            memmove(args, pattern + 1, instruction->textLength + 1);
+            searchCompile(&instruction->searcher, instruction->text, instruction->textLength);
+            return NO_ERROR;
+        }
+        case CMD_SUBSTITUTE:
+        case CMD_SUBSTITUTE_ALL: {
+            char *delimiter = (*args == '\0') ? NULL : strchr(args + 1, *args);
+            if (delimiter == NULL) {
+                fprintf(stderr, "Invalid substitution: %c%s.\n", instruction->cmd, args);
+                return UNKNOWN_COMMAND;
+            }
+            *delimiter = '\0';
+            instruction->replacement = delimiter + 1;
+            instruction->replacementLength = strlen(instruction->replacement);
+            instruction->textLength = (size_t) (delimiter - args) - 1;
+            memmove(args, args + 1, instruction->textLength + 1);
+            if (regexps) {
+                instruction->regexp = malloc(sizeof(regexp_t));
+                if (instruction->regexp == NULL) {
+                    return BUFFER_ERROR;
+                }
+                int status = regexpCompile(instruction->regexp, instruction->text, instruction->textLength);
+                if (status != NO_ERROR) {
+                    free(instruction->regexp);
+                    instruction->regexp = NULL;
+                }
+                return status;
+            }
+            if (instruction->cmd == CMD_SUBSTITUTE_ALL && instruction->textLength == 0) {
+                fprintf(stderr, "Empty pattern of the substitution.\n");
+                return UNKNOWN_COMMAND;
+            }
+            searchCompile(&instruction->searcher, instruction->text, instruction->textLength);
+            return NO_ERROR;
+        }
+        default:
+            fprintf(stderr, "Unknown command: %c.\n", instruction->cmd);
+            return UNKNOWN_COMMAND;
+    }
+}
+
+/**
+ * Resolves targets of goto commands into instruction indexes
+ * @param program Program
+ * @return Execution status
+ */
+static int resolveTargets(program_t *program) {
+    for (size_t i = 0; i < program->count; i++) {
+        instruction_t *instruction = &program->instructions[i];
+        if (instruction->cmd != CMD_GOTO && instruction->cmd != CMD_CONDITIONED_GOTO) {
+            continue;
+        }
+        if (instruction->count < 1) {
+            instruction->count = 1;
+        }
+        if ((unsigned long int) instruction->count - 1 > program->count) {
+            fprintf(stderr, "Goto target out of the script: %ld.\n", instruction->count);
+            return INPUT_READ_ERROR;
+        }
+        instruction->count--;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Finds instructions executed after the instruction
+ * @param program Program
+ * @param i Index of the instruction
+ * @param conditional Include successors of conditioned gotos?
+ * @param next Indexes of the following instructions
+ * @return Count of the following instructions
+ */
+static int successors(const program_t *program, size_t i, bool conditional, size_t next[2]) {
+    const instruction_t *instruction = &program->instructions[i];
+    size_t targets[2] = {i + 1, SIZE_MAX};
+    switch (instruction->cmd) {
+        case CMD_QUIT:
+            return 0;
+        case CMD_GOTO:
+            targets[0] = (size_t) instruction->count;
+            break;
+        case CMD_CONDITIONED_GOTO:
+            if (!conditional) {
+                return 0;
+            }
+            targets[1] = (size_t) instruction->count;
+            break;
+        default:
+            break;
+    }
+    int count = 0;
+    for (int j = 0; j < 2; j++) {
+        if (targets[j] < program->count) {
+            next[count++] = targets[j];
+        }
+    }
+    return count;
+}
+
+/**
+ * Checks if the instruction always reads the input
+ * @param instruction Instruction
+ * @return Does the instruction read the input?
+ */
+static bool consumesInput(const instruction_t *instruction) {
+    return (instruction->cmd == CMD_NEXT || instruction->cmd == CMD_DELETE) && instruction->count >= 1;
+}
+
+/**
+ * Rejects reachable cycles of instructions which read no input, because the
+ * program would never leave them. Cycles through conditioned gotos are taken
+ * only for some inputs, so they are left to the check during the execution.
+ * @param program Program
+ * @return Execution status
+ */
+static int checkCycles(const program_t *program) {
+    if (program->count == 0) {
+        return NO_ERROR;
+    }
+    // 0 unvisited, 1 reachable, 2 on the search path, 3 finished
+    unsigned char *state = calloc(program->count, 1);
+    size_t *stack = malloc(program->count * sizeof(size_t));
+    size_t *edge = malloc(program->count * sizeof(size_t));
+    if (state == NULL || stack == NULL || edge == NULL) {
+        free(state);
+        free(stack);
+        free(edge);
+        return BUFFER_ERROR;
+    }
+    size_t depth = 0;
+    size_t next[2];
+    state[0] = 1;
+    stack[depth++] = 0;
+    while (depth > 0) {
+        size_t i = stack[--depth];
+        for (int j = successors(program, i, true, next) - 1; j >= 0; j--) {
+            if (state[next[j]] == 0) {
+                state[next[j]] = 1;
+                stack[depth++] = next[j];
+            }
+        }
+    }
+    int status = NO_ERROR;
+    for (size_t root = 0; root < program->count && status == NO_ERROR; root++) {
+        if (state[root] != 1 || consumesInput(&program->instructions[root])) {
+            continue;
+        }
+        state[root] = 2;
+        stack[0] = root;
+        edge[0] = 0;
+        depth = 1;
+        while (depth > 0 && status == NO_ERROR) {
+            size_t i = stack[depth - 1];
+            int count = successors(program, i, false, next);
+            if (edge[depth - 1] == (size_t) count) {
+                state[i] = 3;
+                depth--;
+                continue;
+            }
+            size_t target = next[edge[depth - 1]++];
+            if (consumesInput(&program->instructions[target]) || state[target] == 3) {
+                continue;
+            }
+            if (state[target] == 2) {
+                fprintf(stderr, "Infinite loop without reading the input on the line %zu.\n", target + 1);
+                status = INFINITE_LOOP;
+                continue;
+            }
+            state[target] = 2;
+            stack[depth] = target;
+            edge[depth] = 0;
+            depth++;
+        }
+    }
+    free(state);
+    free(stack);
+    free(edge);
+    return status;
+}
+
+/**
+ * Compiles the command script read by the reader
+ * @param reader Reader of the script
+ * @param program Compiled program
+ * @param regexps Are patterns of substitutions regular expressions?
+ * @return Execution status
+ */
+static int compileScript(reader_t *reader, program_t *program, bool regexps) {
+    program->instructions = NULL;
+    program->count = 0;
+    program->regexpCount = 0;
+    size_t capacity = 0;
+    line_t line;
+    int status;
+    while ((status = readerNext(reader, &line)) == NO_ERROR) {
+        if (program->count == capacity) {
+            capacity = 2 * capacity + 16;
+            instruction_t *instructions = realloc(program->instructions, capacity * sizeof(instruction_t));
+            if (instructions == NULL) {
+                status = BUFFER_ERROR;
+                break;
+            }
+            program->instructions = instructions;
+        }
+        instruction_t *instruction = &program->instructions[program->count];
+        status = compileCommand(line, instruction, regexps);
+        program->count++;
+        if (instruction->regexp != NULL) {
+            instruction->regexpIndex = program->regexpCount++;
+        }
+        if (status != NO_ERROR) {
+            break;
+        }
+    }
+    if (status == FILE_END) {
+        status = resolveTargets(program);
+    }
+    if (status == NO_ERROR) {
+        status = checkCycles(program);
+    }
+    if (status != NO_ERROR) {
+        programFree(program);
+    }
+    return status;
+}
+
+/**
+ * Compiles the command script
+ * @param fd File descriptor of the script
+ * @param program Compiled program
+ * @param regexps Are patterns of substitutions regular expressions?
+ * @return Execution status
+ */
+int programCompile(int fd, program_t *program, bool regexps) {
+    program->instructions = NULL;
+    program->count = 0;
+    program->regexpCount = 0;
+    reader_t reader;
+    int status = readerOpen(&reader, fd);
+    if (status == NO_ERROR) {
+        status = compileScript(&reader, program, regexps);
+    }
+    readerClose(&reader);
+    return status;
+}
+
+/**
+ * Compiles the command script in the memory
+ * @param script Script, it is not needed after the compilation
+ * @param length Length of the script
+ * @param program Compiled program
+ * @param regexps Are patterns of substitutions regular expressions?
+ * @return Execution status
+ */
+int programCompileMemory(const char *script, size_t length, program_t *program, bool regexps) {
+    reader_t reader;
+    readerOpenMemory(&reader, script, length);
+    int status = compileScript(&reader, program, regexps);
+    readerClose(&reader);
+    return status;
+}
+
+/**
+ * Frees the compiled program
+ * @param program Program
+ */
+void programFree(program_t *program) {
+    for (size_t i = 0; i < program->count; i++) {
+        free(program->instructions[i].text);
+        if (program->instructions[i].regexp != NULL) {
+            regexpFree(program->instructions[i].regexp);
+            free(program->instructions[i].regexp);
+        }
+    }
+    free(program->instructions);
+    program->instructions = NULL;
+    program->count = 0;
+    program->regexpCount = 0;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "regexp.h"
+#include "search.h"
+
+/**
+ * Commands
+ */
+enum commands {
+    CMD_INSERT = 'i',
+    CMD_APPEND = 'a',
+    CMD_BEFORE = 'b',
+    CMD_DELETE = 'd',
+    CMD_REMOVE = 'r',
+    CMD_NEXT = 'n',
+    CMD_QUIT = 'q',
+    CMD_GOTO = 'g',
+    CMD_SUBSTITUTE = 's',
+    CMD_SUBSTITUTE_ALL = 'S',
+    CMD_EOL = 'e',
+    CMD_FIND = 'f',
+    CMD_CONDITIONED_GOTO = 'c',
+};
+
+/**
+ * Compiled command with pre-parsed arguments
+ */
+typedef struct {
+    /// Command
+    enum commands cmd;
+    /// Count of repeats (d, n) or index of the target instruction (g, c)
+    long int count;
+    /// Inserted text (i, a, b) or pattern (s, S, f, c)
+    char *text;
+    /// Length of the text
+    size_t textLength;
+    /// Replacement (s, S)
+    char *replacement;
+    /// Length of the replacement
+    size_t replacementLength;
+    /// Searcher of the pattern (s, S, f, c)
+    searcher_t searcher;
+    /// Compiled pattern if patterns are regular expressions (s, S), NULL otherwise
+    regexp_t *regexp;
+    /// Index of the regular expression in the program (s, S)
+    size_t regexpIndex;
+} instruction_t;
+
+/**
+ * Compiled command script
+ */
+typedef struct {
+    /// Instructions in the script order
+    instruction_t *instructions;
+    /// Count of instructions
+    size_t count;
+    /// Count of regular expressions
+    size_t regexpCount;
+} program_t;
+
+int programCompile(int fd, program_t *program, bool regexps);
+
+int programCompileMemory(const char *script, size_t length, program_t *program, bool regexps);
+
+void programFree(program_t *program);
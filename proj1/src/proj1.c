@@ -20,413 +20,164 @@
  * Autor: Roman Ondráček (login xondra58)
  * Implementované volitelní příkazy:
  *  - e (append EOL) přidej na konec aktuálního řádku znak konce řádku
+ *  - fPATTERN (find) tiskne řádky, dokud další řádek neobsahuje PATTERN
+ *  - cX PATTERN (conditioned goto) skočí na X-tý příkaz, pokud další řádek obsahuje PATTERN
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-#define BUFFER_SIZE 1024
-#define COMMAND_SIZE 16
+#include "batch.h"
+#include "convert.h"
+#include "execute.h"
+#include "proj1.h"
+#include "ring.h"
 
 /**
- * Exit codes
- */
-enum exitStatuses {
-    NO_ERROR,
-    INPUT_READ_ERROR,
-    FILE_READ_ERROR,
-    FILE_END,
-    CONVERSION_ERROR,
-    BUFFER_ERROR,
-    UNKNOWN_COMMAND,
-    NOT_FOUND
-};
-
-/**
- * Commands
- */
-enum commands {
-    CMD_INSERT = 'i',
-    CMD_APPEND = 'a',
-    CMD_BEFORE = 'b',
-    CMD_DELETE = 'd',
-    CMD_REMOVE = 'r',
-    CMD_NEXT = 'n',
-    CMD_QUIT = 'q',
-    CMD_GOTO = 'g',
-    CMD_SUBSTITUTE = 's',
-    CMD_SUBSTITUTE_ALL = 'S',
-    CMD_EOL = 'e'
-//  CMD_FIND = 'f',
-//  CMD_CONDITIONED_GOTO = 'c',
-};
-
-/**
- * Structure for commands
- */
-typedef struct {
-    enum commands cmd;
-    char args[BUFFER_SIZE - 1];
-} command_t;
-
-/**
- * Structure for substitution commands
+ * Command line options
  */
 typedef struct {
-    int count;
-    command_t cmds[COMMAND_SIZE];
-} substituteCmds_t;
-
-/**
- * Chack if execution has error status
- * @param status Execution status
- * @return Has error status?
- */
-bool checkStatus(int status) {
-    return (status != NO_ERROR);
-}
-
-/**
- * Remove a new line from the string
- * @param str String
- */
-void removeNewLine(char *str) {
-    size_t pos = strcspn(str, "\n");
-    str[pos] = '\0';
-}
-
-/**
- * Get count of the command repeats
- * @param command Command to cast
- * @param count Count of the command repeats
- */
-int getRepeatsCount(command_t command, long int *count) {
-    char *endptr;
-    if ((strlen(command.args) == 0)) {
-        *count = 1;
-        return NO_ERROR;
-    }
-    *count = strtol(command.args, &endptr, 10);
-    if (*endptr != '\0') {
-        fprintf(stderr, "Error in string conversion to int.");
-        return CONVERSION_ERROR;
-    }
-    return NO_ERROR;
-}
-
-/**
- * Create command from a line
- * @param char* line Line to parse
- * @param command_t command Parsed command
- */
-command_t createCommand(char *line) {
-    command_t command = {'\0', ""};
-    command.cmd = line[0];
-    strcpy(command.args, &line[1]);
-    removeNewLine(command.args);
-    return command;
-}
-
-/**
- * Replace string
- * @param source Source string buffer
- * @param pattern Pattern to replace
- * @param replacement Replacement
+    /// Apply substitutions one after another?
+    bool sequential;
+    /// Are patterns of substitutions regular expressions?
+    bool regexps;
+    /// Count of threads, 0 for the count of processors
+    unsigned int jobs;
+    /// Profile the execution?
+    bool profile;
+    /// Print the profile as JSON?
+    bool json;
+    /// Manifest of the batch of files, NULL to process stdin
+    const char *manifest;
+} options_t;
+
+/**
+ * Execute the compiled script on the input stream
+ * @param script Compiled script
+ * @param jobs Count of threads
+ * @param input Input file descriptor
+ * @param output Output file descriptor
+ * @param profile Profile of the execution, NULL if it is disabled
  * @return Execution status
  */
-int strReplace(char *source, char *pattern, char *replacement) {
-    char tmpBuffer[BUFFER_SIZE];
-    char *p = strstr(source, pattern);
-    if (p == NULL) {
-        return NOT_FOUND;
+int executeStream(const script_t *script, unsigned int jobs, int input, int output, profile_t *profile) {
+    reader_t reader;
+    writer_t writer;
+    if (readerOpen(&reader, input) != NO_ERROR) {
+        readerClose(&reader);
+        return BUFFER_ERROR;
     }
-    unsigned long int rPos = p - source;
-    strncpy(tmpBuffer, source, rPos);
-    tmpBuffer[rPos] = '\0';
-    strcat(tmpBuffer, replacement);
-    strcat(tmpBuffer, p + strlen(pattern));
-    strcpy(source, tmpBuffer);
-    return NO_ERROR;
-}
-
-/**
- * Read line from stdin
- * @param inputBuffer Buffer for data from stdin
- * @return Execution status
- */
-int readLine(char *inputBuffer) {
-    if (fgets(inputBuffer, BUFFER_SIZE, stdin) == NULL) {
-        if (feof(stdin)) {
-            return FILE_END;
-        }
-        return INPUT_READ_ERROR;
+    if (writerOpen(&writer, output) != NO_ERROR) {
+        writerClose(&writer);
+        readerClose(&reader);
+        return BUFFER_ERROR;
     }
-    removeNewLine(inputBuffer);
-    return NO_ERROR;
+    int status = executeScript(script, jobs, NULL, &reader, &writer, profile);
+    writerClose(&writer);
+    readerClose(&reader);
+    return status;
 }
 
 /**
- * Add substitution command to the buffer
- * @param command Substitution command
- * @param substituteCmds Buffer with sunbstitution commands
+ * Execute the compiled script on one file of the batch
+ * @param input Path of the input file
+ * @param output Path of the output file
+ * @param argument Compiled script
  * @return Execution status
  */
-int addSubstituteCommand(command_t command, substituteCmds_t *substituteCmds) {
-    if (substituteCmds->count == COMMAND_SIZE) {
-        fprintf(stderr, "Too much command for substitution.\n");
-        return UNKNOWN_COMMAND;
+int executeFile(const char *input, const char *output, void *argument) {
+    int inputFile = open(input, O_RDONLY);
+    if (inputFile < 0) {
+        fprintf(stderr, "proj1: %s: %s\n", input, strerror(errno));
+        return FILE_READ_ERROR;
     }
-    substituteCmds->cmds[substituteCmds->count] = command;
-    substituteCmds->count++;
-    return NO_ERROR;
-}
-
-/**
- * Apply substitution command on the user's input
- * @param commands Substitution commands
- * @param buffer Buffer
- * @return Execution status
- */
-int applySubstitutionCommands(substituteCmds_t *commands, char *buffer) {
-    for (int i = 0; i < commands->count; i++) {
-        command_t cmd = commands->cmds[i];
-        char delimiter = cmd.args[0];
-        if (delimiter == '\0') {
-            break;
-        }
-        char pattern[BUFFER_SIZE] = "";
-        char replacement[BUFFER_SIZE] = "";
-        char tmpBuffer[BUFFER_SIZE] = "";
-        strcpy(tmpBuffer, &cmd.args[1]);
-        strncpy(pattern, tmpBuffer, strchr(tmpBuffer, delimiter) - tmpBuffer);
-        strcpy(replacement, strchr(tmpBuffer, delimiter) + 1);
-        int replacementStatus = NO_ERROR;
-        if (cmd.cmd == CMD_SUBSTITUTE_ALL) {
-            while (replacementStatus == NO_ERROR) {
-                replacementStatus = strReplace(buffer, pattern, replacement);
-            }
-        } else {
-            strReplace(buffer, pattern, replacement);
-        }
+    int outputFile = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (outputFile < 0) {
+        fprintf(stderr, "proj1: %s: %s\n", output, strerror(errno));
+        close(inputFile);
+        return OUTPUT_WRITE_ERROR;
     }
-    commands->count = 0;
-    return NO_ERROR;
-}
-
-/**
- * Command for line deletion
- * @param command Command
- * @return Execution status
- */
-int commandDelete(command_t command) {
-    long int count;
-    if (getRepeatsCount(command, &count) == CONVERSION_ERROR) {
-        return CONVERSION_ERROR;
+    int status = executeStream(argument, 1, inputFile, outputFile, NULL);
+    close(inputFile);
+    if (close(outputFile) != 0 && status == NO_ERROR) {
+        status = OUTPUT_WRITE_ERROR;
     }
-    char inputBuffer[BUFFER_SIZE] = "";
-    for (int i = 0; i < count; i++) {
-        int status = readLine(inputBuffer);
-        if (checkStatus(status)) {
-            return status;
-        }
+    if (status != NO_ERROR) {
+        fprintf(stderr, "proj1: %s: failed with the status %d\n", input, status);
     }
-    return NO_ERROR;
+    return status;
 }
 
 /**
- * Add EOL after the current line
- * @param command Command
- * @param outputBuffer Output buffer
+ * Compile the command file and execute it on stdin or on the batch of files
+ * Profiled programs are always interpreted command by command. Files of the
+ * batch are processed in parallel, each of them by one thread.
+ * @param fileName Name of the file with commands
+ * @param options Command line options
  * @return Execution status
  */
-int commandAddEol(char *outputBuffer) {
-    if (strcat(outputBuffer, "\n") == NULL) {
-        return BUFFER_ERROR;
+int parseCommandFile(const char *fileName, options_t options) {
+    int commandFile = open(fileName, O_RDONLY);
+    if (commandFile < 0) {
+        perror("proj1");
+        return FILE_READ_ERROR;
     }
-    return NO_ERROR;
-}
-
-/**
- * Inject prefix or suffix to user's input
- * @param command Command (append or before)
- * @param outputBuffer Output buffer
- * @return Execution status
- */
-int commandInject(command_t command, char *outputBuffer) {
-    char buffer[BUFFER_SIZE];
-    if (strcpy(buffer, outputBuffer) == NULL) {
-        return BUFFER_ERROR;
+    program_t program;
+    int output = programCompile(commandFile, &program, options.regexps);
+    close(commandFile);
+    if (output != NO_ERROR) {
+        return output;
+    }
+    loop_t loop;
+    script_t script = {&program, NULL, options.sequential};
+    if (!options.profile && loopAnalyse(&program, &loop)) {
+        script.loop = &loop;
+    }
+    unsigned int jobs = (options.jobs == 0) ? ringThreads() : options.jobs;
+    if (options.manifest != NULL) {
+        output = batchExecute(options.manifest, jobs, executeFile, &script);
+    } else if (options.profile) {
+        profile_t profile;
+        output = profileOpen(&profile, program.count, options.json);
+        if (output == NO_ERROR) {
+            output = executeStream(&script, jobs, STDIN_FILENO, STDOUT_FILENO, &profile);
+            profileReport(&profile, &program, stderr);
+        }
+        profileClose(&profile);
+    } else {
+        output = executeStream(&script, jobs, STDIN_FILENO, STDOUT_FILENO, NULL);
     }
-    switch (command.cmd) {
-        case CMD_APPEND:
-            sprintf(outputBuffer, "%s%s", buffer, command.args);
-            break;
-        case CMD_BEFORE:
-            sprintf(outputBuffer, "%s%s", command.args, buffer);
-            break;
-        default:
-            break;
+    if (script.loop != NULL) {
+        loopFree(&loop);
     }
-    return NO_ERROR;
-}
-
-/**
- * Command for line insertion
- * @param command Command
- * @return Execution status
- */
-int commandInsert(command_t command) {
-    puts(command.args);
-    return NO_ERROR;
+    programFree(&program);
+    return output;
 }
 
 /**
- * Command for moving to line in the file with commands
- * @param command Command
- * @param file File with commands
+ * Converts the argument of --jobs into the count of threads
+ * @param string String to convert
+ * @param jobs Converted count of threads, 0 for the count of processors
  * @return Execution status
- * @todo Add cycle detection
  */
-int commandGoto(command_t command, FILE *file) {
-    long int line;
-    if (getRepeatsCount(command, &line) == CONVERSION_ERROR) {
+int parseJobs(const char *string, unsigned int *jobs) {
+    unsigned long number;
+    if (strToULong(string, &number) != NO_ERROR) {
         return CONVERSION_ERROR;
     }
-    char buffer[BUFFER_SIZE];
-    rewind(file);
-    for (int i = 1; i < line; i++) {
-        if (fgets(buffer, BUFFER_SIZE - 1, file) == NULL) {
-            return INPUT_READ_ERROR;
-        }
-    }
-    return NO_ERROR;
-}
-
-/**
- * Command for line(s) printing
-  * @param command Command
-  * @param beforeBuffer Before output buffer
-  * @param afterBuffer After output buffer
-  * @return Execution status
-  */
-int
-commandNext(command_t command, char *beforeBuffer, char *afterBuffer, bool *newLine, substituteCmds_t *substituteCmds) {
-    long int count;
-    if (getRepeatsCount(command, &count) == CONVERSION_ERROR) {
+    if (number > RING_MAX_THREADS) {
+        fprintf(stderr, "Invalid count of jobs %lu, expected at most %d.\n", number, RING_MAX_THREADS);
         return CONVERSION_ERROR;
     }
-    char inputBuffer[BUFFER_SIZE] = "";
-    char outputBuffer[4 * BUFFER_SIZE] = "";
-    for (int i = 0; i < count; i++) {
-        int status = readLine(inputBuffer);
-        if (checkStatus(status)) {
-            return status;
-        }
-        if (*newLine) {
-            commandAddEol(afterBuffer);
-        } else {
-            *newLine = true;
-        }
-        sprintf(outputBuffer, "%s%s%s", beforeBuffer, inputBuffer, afterBuffer);
-        afterBuffer[0] = beforeBuffer[0] = inputBuffer[0] = '\0';
-        int substitutionStatus = applySubstitutionCommands(substituteCmds, outputBuffer);
-        if (substitutionStatus != NO_ERROR) {
-            break;
-        }
-        printf("%s", outputBuffer);
-        outputBuffer[0] = '\0';
-    }
-    return NO_ERROR;
-}
-
-/**
- * Parse commands from the file
- * @param commandFile File with commands
- * @return Execution status
- */
-int parseCommands(FILE *commandFile) {
-    char commandBuffer[BUFFER_SIZE] = "";
-    char beforeBuffer[BUFFER_SIZE] = "";
-    char afterBuffer[BUFFER_SIZE] = "";
-    // Dirty substitution command solution
-    substituteCmds_t substituteCmds;
-    substituteCmds.count = 0;
-    bool newLine = true;
-    int status = NO_ERROR;
-    while (fgets(commandBuffer, BUFFER_SIZE - 2, commandFile) != NULL) {
-        command_t command = createCommand(commandBuffer);
-        switch (command.cmd) {
-            case CMD_APPEND:
-                status = commandInject(command, afterBuffer);
-                break;
-            case CMD_BEFORE:
-                status = commandInject(command, beforeBuffer);
-                break;
-            case CMD_INSERT:
-                status = commandInsert(command);
-                break;
-            case CMD_DELETE:
-                status = commandDelete(command);
-                break;
-            case CMD_REMOVE:
-                newLine = false;
-                break;
-            case CMD_NEXT:
-                status = commandNext(command, beforeBuffer, afterBuffer, &newLine, &substituteCmds);
-                break;
-            case CMD_GOTO:
-                status = commandGoto(command, commandFile);
-                break;
-            case CMD_EOL:
-                status = commandAddEol(afterBuffer);
-                break;
-            case CMD_SUBSTITUTE:
-            case CMD_SUBSTITUTE_ALL:
-                status = addSubstituteCommand(command, &substituteCmds);
-                break;
-            case CMD_QUIT:
-                return NO_ERROR;
-            default:
-                fprintf(stderr, "Unknown command: %c.\n", command.cmd);
-                return UNKNOWN_COMMAND;
-        }
-        if (checkStatus(status)) {
-            return status;
-        }
-    }
-    char inputBuffer[BUFFER_SIZE] = "";
-    do {
-        status = readLine(inputBuffer);
-        if (checkStatus(status)) {
-            return status;
-        }
-        puts(inputBuffer);
-    } while (!feof(stdin));
+    *jobs = (unsigned int) number;
     return NO_ERROR;
 }
 
-/**
- * Parse commands from file
- * @param argv Values of the program's parameters
- * @return Execution status
- */
-int parseCommandFile(char *argv[]) {
-    FILE *commandFile;
-    if ((commandFile = fopen(argv[1], "r")) == NULL) {
-        perror("proj1");
-        return FILE_READ_ERROR;
-    }
-    int output = parseCommands(commandFile);
-    fclose(commandFile);
-    if (output == FILE_END) {
-        return NO_ERROR;
-    }
-    return output;
-}
-
 /**
  * Print program's usage
  * @return Execution status
@@ -434,6 +185,11 @@ int parseCommandFile(char *argv[]) {
 int printUsage() {
     puts("Usage: ./proj1 [options] file_with_commands");
     puts("Options:");
+    puts("\t-E, --regexp\t\tTreats patterns of substitutions as regular expressions");
+    puts("\t--sequential\t\tApplies substitutions one after another instead of in one pass");
+    puts("\t-j, --jobs N\t\tProcesses independent lines with N threads, at most 256 (default all cores)");
+    puts("\t--profile[=json]\tReports counters of every command into stderr at exit");
+    puts("\t--batch MANIFEST\tProcesses files listed in MANIFEST as \"INPUT<tab>OUTPUT\" lines");
     puts("\t-h, --help\t\tPrints help (this message) and exit");
     return NO_ERROR;
 }
@@ -445,8 +201,37 @@ int printUsage() {
  * @return Execution status
  */
 int main(int argc, char *argv[]) {
+    options_t options = {false, false, 0, false, false, NULL};
+    while (argc > 2) {
+        if (strcmp(argv[1], "--sequential") == 0) {
+            options.sequential = true;
+        } else if ((strcmp(argv[1], "--regexp") == 0) || (strcmp(argv[1], "-E") == 0)) {
+            options.regexps = true;
+        } else if ((strcmp(argv[1], "--profile") == 0) || (strcmp(argv[1], "--profile=json") == 0)) {
+            options.profile = true;
+            options.json = (argv[1][9] == '=');
+        } else if (argc > 3 && strcmp(argv[1], "--batch") == 0) {
+            options.manifest = argv[2];
+            argc--;
+            argv++;
+        } else if (argc > 3 && ((strcmp(argv[1], "--jobs") == 0) || (strcmp(argv[1], "-j") == 0))) {
+            if (parseJobs(argv[2], &options.jobs) != NO_ERROR) {
+                return CONVERSION_ERROR;
+            }
+            argc--;
+            argv++;
+        } else {
+            break;
+        }
+        argc--;
+        argv++;
+    }
     if ((argc != 2) || (strcmp(argv[1], "--help") == 0) || (strcmp(argv[1], "-h") == 0)) {
         return printUsage();
     }
-    return parseCommandFile(argv);
+    if (options.profile && options.manifest != NULL) {
+        fprintf(stderr, "The profile is not available in the batch mode.\n");
+        return CONVERSION_ERROR;
+    }
+    return parseCommandFile(argv[1], options);
 }
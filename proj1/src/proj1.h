@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+ * Exit codes
+ */
+enum exitStatuses {
+    NO_ERROR,
+    INPUT_READ_ERROR,
+    FILE_READ_ERROR,
+    FILE_END,
+    CONVERSION_ERROR,
+    BUFFER_ERROR,
+    UNKNOWN_COMMAND,
+    NOT_FOUND,
+    OUTPUT_WRITE_ERROR,
+    INFINITE_LOOP
+};
@@ -0,0 +1,76 @@
+/*
+ * Embeddable editing engine of proj1. The script is compiled once into
+ * a program object, which is read-only afterwards, so one program may be
+ * executed on any count of inputs by any count of threads at once:
+ *
+ *     editProgram_t *program;
+ *     if (editCompile("s/ERROR/error\n", 14, EDIT_SEQUENTIAL, &program) == NO_ERROR) {
+ *         editExecute(program, record, recordLength, appendOutput, &output);
+ *         editFree(program);
+ *     }
+ *
+ * Callers executing the program on many small records keep one context per
+ * thread, it holds the matchers of the regular expressions and the output
+ * buffer across executions, editExecute creates and frees one every call:
+ *
+ *     editContext_t *context;
+ *     if (editContextCreate(program, &context) == NO_ERROR) {
+ *         while (nextRecord(&record, &recordLength)) {
+ *             editExecuteWith(context, record, recordLength, appendOutput, &output);
+ *         }
+ *         editContextFree(context);
+ *     }
+ *
+ * The output is handed to the sink in pieces, the input is never copied.
+ * Errors of the script, both at the compilation (unknown commands, goto
+ * targets out of the script) and at the execution (infinite loops), are
+ * printed to stderr like by the proj1 executable, besides being returned as
+ * the status.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "proj1.h"
+
+/**
+ * Flags of the compilation
+ */
+enum editFlags {
+    /// Patterns of substitutions are regular expressions
+    EDIT_REGEXP = 1 << 0,
+    /// Substitutions are applied one after another instead of in one pass
+    EDIT_SEQUENTIAL = 1 << 1,
+};
+
+/**
+ * Compiled script
+ */
+typedef struct editProgram editProgram_t;
+
+/**
+ * Execution context of one compiled script, used by one thread at a time
+ */
+typedef struct editContext editContext_t;
+
+/**
+ * Consumer of the output
+ * @param data Piece of the output, valid only during the call
+ * @param length Length of the piece
+ * @param argument Argument passed to editExecute or editExecuteWith
+ * @return 0 on success, anything else stops the execution with OUTPUT_WRITE_ERROR
+ */
+typedef int (*editSink_t)(const char *data, size_t length, void *argument);
+
+int editCompile(const char *script, size_t length, unsigned int flags, editProgram_t **program);
+
+int editExecute(const editProgram_t *program, const char *input, size_t length, editSink_t sink, void *argument);
+
+int editContextCreate(const editProgram_t *program, editContext_t **context);
+
+int editExecuteWith(editContext_t *context, const char *input, size_t length, editSink_t sink, void *argument);
+
+void editContextFree(editContext_t *context);
+
+void editFree(editProgram_t *program);
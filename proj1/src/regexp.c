@@ -0,0 +1,1271 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Regular expressions without backtracking. The pattern is parsed into a
+ * syntax tree and compiled into two Thompson NFAs, one for the expression and
+ * one for the reversed expression preceded by a loop over any character.
+ * Searches run on DFAs built lazily from the NFAs: a DFA state is a set of NFA
+ * states and its transitions are computed the first time they are needed and
+ * cached, so every character of the text is examined a constant count of times
+ * no matter how the pattern looks. The cache is flushed when it grows too big.
+ *
+ * The leftmost-longest match is found in two steps. The reverse DFA scans the
+ * line once from its end and marks every position where a match starts, the
+ * forward DFA then runs from the first mark and remembers the last position
+ * where it was in a matching state. The run may go far behind the end of
+ * its match, so runs of S could scan the same text again and again. Once the
+ * runs on a line have scanned more than twice its length, every pair of
+ * a position and a DFA state is remembered with the run that visited it.
+ * A later run reaching a visited pair continues exactly like the earlier run,
+ * so it stops and takes over its result. Every pair is scanned at most once,
+ * which keeps the search linear in the length of the line.
+ *
+ * Syntax: literal characters, ".", bracket expressions "[a-z]" and "[^a-z]",
+ * "*", "+", "?", "|", "(...)", "^" and "$" (at the start and the end of the
+ * line or next to a new line) and escapes "\n", "\t", "\d", "\w", "\s" and "\"
+ * followed by any other character, which stands for that character. Only
+ * "\n" itself matches a new line, neither ".", "\s" nor "[^...]" does.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "proj1.h"
+#include "regexp.h"
+
+/// Maximal count of cached DFA states
+#define DFA_MAX_STATES 4096
+/// Sentinel of a not yet computed DFA transition
+#define DFA_UNKNOWN (-1)
+/// Maximal count of remembered pairs of positions and DFA states
+#define MEMO_MAX_VISITS (1 << 20)
+/// Run end of a run which has not finished yet
+#define MEMO_RUNNING SIZE_MAX
+/// Maximal nesting of parentheses, the parser and the NFA compiler recurse once per level
+#define REGEXP_MAX_DEPTH 256
+/// Maximal count of subtrees of a chain, enough for any count of nodes
+#define CHAIN_SIZE 64
+
+/**
+ * Kinds of NFA states
+ */
+enum nfaKinds {
+    /// Consumes a character from the set
+    NFA_SET,
+    /// Continues in both following states
+    NFA_SPLIT,
+    /// Matches at the start of a line
+    NFA_BOL,
+    /// Matches at the end of a line
+    NFA_EOL,
+    /// Accepts
+    NFA_MATCH,
+};
+
+/**
+ * Kinds of syntax tree nodes
+ */
+enum astKinds {
+    AST_EMPTY,
+    AST_SET,
+    AST_CONCAT,
+    AST_ALTERNATE,
+    AST_STAR,
+    AST_PLUS,
+    AST_QUEST,
+    AST_BOL,
+    AST_EOL,
+};
+
+/**
+ * Node of the syntax tree
+ */
+typedef struct {
+    /// Kind of the node
+    unsigned char kind;
+    /// Left (or only) child
+    int left;
+    /// Right child
+    int right;
+    /// Character set (set)
+    uint32_t set[8];
+} astNode_t;
+
+/**
+ * State of the pattern parser
+ */
+typedef struct {
+    /// Pattern
+    const char *pattern;
+    /// Length of the pattern
+    size_t length;
+    /// Position of the parser
+    size_t position;
+    /// Nodes of the syntax tree
+    astNode_t *nodes;
+    /// Count of nodes
+    int count;
+    /// Capacity of nodes
+    int capacity;
+    /// Nesting of parentheses at the position
+    int depth;
+    /// Error status
+    int status;
+} parser_t;
+
+/**
+ * Chain of nodes joined by one associative kind
+ * The chain is kept as a list of perfect subtrees with decreasing heights,
+ * like digits of a binary counter, so the tree is only logarithmically deep
+ * however long the chain is and compiling it never recurses too deep.
+ */
+typedef struct {
+    /// Kind of joining nodes
+    unsigned char kind;
+    /// Roots of subtrees in the order of the pattern
+    int roots[CHAIN_SIZE];
+    /// Heights of subtrees
+    unsigned char heights[CHAIN_SIZE];
+    /// Count of subtrees
+    int count;
+} chain_t;
+
+/**
+ * State of the lazily built DFA
+ */
+typedef struct {
+    /// Offset of the NFA state set in the pool
+    size_t set;
+    /// Count of NFA states in the set
+    int count;
+    /// Is the state at the start of a line?
+    bool lineStart;
+    /// Does the state accept?
+    bool match;
+    /// Does the state accept at the end of a line?
+    bool matchEol;
+    /// Cached transitions
+    int next[256];
+} dfaState_t;
+
+struct dfa {
+    /// Underlying NFA
+    const nfa_t *nfa;
+    /// States
+    dfaState_t *states;
+    /// Count of states
+    int count;
+    /// Capacity of states
+    int capacity;
+    /// Pool of NFA state sets
+    int *pool;
+    /// Used length of the pool
+    size_t poolLength;
+    /// Capacity of the pool
+    size_t poolCapacity;
+    /// Hash table of states, indexes or -1
+    int *table;
+    /// Initial states for positions inside and at the start of a line
+    int start[2];
+    /// Count of cache flushes
+    unsigned int flushes;
+    /// Visit marks of NFA states used by the closure
+    unsigned int *visited;
+    /// Current visit mark
+    unsigned int generation;
+    /// Stack of the closure
+    int *stack;
+    /// Work set of NFA states
+    int *work;
+    /// Second work set of NFA states
+    int *work2;
+};
+
+/**
+ * Pair of a position and a forward DFA state visited by a longest-match run
+ */
+typedef struct {
+    /// Position in the text
+    size_t position;
+    /// Index of the DFA state
+    int state;
+    /// Index of the run which visited the pair
+    unsigned int run;
+    /// Generation of the table the pair belongs to, 0 for an empty slot
+    unsigned int generation;
+} visit_t;
+
+/**
+ * Pairs visited by longest-match runs on the prepared text
+ */
+struct memo {
+    /// Hash table of visited pairs
+    visit_t *visits;
+    /// Capacity of the table, a power of two
+    size_t capacity;
+    /// Count of pairs of the current generation
+    size_t count;
+    /// Ends of the longest matches found by runs, indexed by runs
+    size_t *ends;
+    /// Count of runs
+    unsigned int runCount;
+    /// Capacity of the ends
+    unsigned int runCapacity;
+    /// Current generation of the table, older pairs are empty slots
+    unsigned int generation;
+    /// Count of DFA cache flushes when the generation started
+    unsigned int flushes;
+    /// Count of characters scanned by runs on the text
+    size_t scanned;
+    /// Count of scanned characters after which pairs are remembered
+    size_t limit;
+};
+
+/**
+ * Adds the node into the syntax tree
+ * @param parser Parser
+ * @param kind Kind of the node
+ * @param left Left child
+ * @param right Right child
+ * @return Index of the node, -1 on error
+ */
+static int astAdd(parser_t *parser, unsigned char kind, int left, int right) {
+    if (parser->count == parser->capacity) {
+        int capacity = 2 * parser->capacity + 16;
+        astNode_t *nodes = realloc(parser->nodes, (size_t) capacity * sizeof(astNode_t));
+        if (nodes == NULL) {
+            parser->status = BUFFER_ERROR;
+            return -1;
+        }
+        parser->nodes = nodes;
+        parser->capacity = capacity;
+    }
+    astNode_t *node = &parser->nodes[parser->count];
+    memset(node, 0, sizeof(*node));
+    node->kind = kind;
+    node->left = left;
+    node->right = right;
+    return parser->count++;
+}
+
+/**
+ * Adds the character into the set
+ * @param set Character set
+ * @param c Character
+ */
+static inline void setAdd(uint32_t set[8], unsigned char c) {
+    set[c >> 5] |= (uint32_t) 1 << (c & 31);
+}
+
+/**
+ * Checks if the set contains the character
+ * @param set Character set
+ * @param c Character
+ * @return Does the set contain the character?
+ */
+static inline bool setContains(const uint32_t set[8], unsigned char c) {
+    return (set[c >> 5] >> (c & 31)) & 1;
+}
+
+/**
+ * Adds characters of the escape class into the set
+ * @param set Character set
+ * @param c Escaped character
+ * @return Is the escape a class?
+ */
+static bool setAddClass(uint32_t set[8], char c) {
+    switch (c) {
+        case 'd':
+            for (int i = '0'; i <= '9'; i++) {
+                setAdd(set, (unsigned char) i);
+            }
+            return true;
+        case 'w':
+            for (int i = 0; i < 256; i++) {
+                if ((i >= '0' && i <= '9') || (i >= 'a' && i <= 'z') || (i >= 'A' && i <= 'Z') || i == '_') {
+                    setAdd(set, (unsigned char) i);
+                }
+            }
+            return true;
+        case 's':
+            // The new line separates lines, so like "." the class never matches it
+            setAdd(set, ' ');
+            for (int i = '\t'; i <= '\r'; i++) {
+                if (i != '\n') {
+                    setAdd(set, (unsigned char) i);
+                }
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Converts the escaped character into the character it stands for
+ * @param c Escaped character
+ * @return Character
+ */
+static unsigned char escapeCharacter(char c) {
+    switch (c) {
+        case 'n':
+            return '\n';
+        case 't':
+            return '\t';
+        default:
+            return (unsigned char) c;
+    }
+}
+
+/**
+ * Parses the bracket expression, the parser stands behind "["
+ * @param parser Parser
+ * @return Index of the node, -1 on error
+ */
+static int parseBracket(parser_t *parser) {
+    int node = astAdd(parser, AST_SET, -1, -1);
+    if (node < 0) {
+        return -1;
+    }
+    uint32_t set[8] = {0};
+    bool negated = false;
+    if (parser->position < parser->length && parser->pattern[parser->position] == '^') {
+        negated = true;
+        parser->position++;
+    }
+    bool first = true;
+    for (;;) {
+        if (parser->position >= parser->length) {
+            fprintf(stderr, "Unterminated bracket expression in the pattern.\n");
+            parser->status = UNKNOWN_COMMAND;
+            return -1;
+        }
+        char c = parser->pattern[parser->position++];
+        if (c == ']' && !first) {
+            break;
+        }
+        first = false;
+        unsigned char low = (unsigned char) c;
+        if (c == '\\' && parser->position < parser->length) {
+            c = parser->pattern[parser->position++];
+            if (setAddClass(set, c)) {
+                continue;
+            }
+            low = escapeCharacter(c);
+        }
+        unsigned char high = low;
+        if (parser->position + 1 < parser->length && parser->pattern[parser->position] == '-' &&
+            parser->pattern[parser->position + 1] != ']') {
+            high = (unsigned char) parser->pattern[parser->position + 1];
+            parser->position += 2;
+            if (high == '\\' && parser->position < parser->length) {
+                high = escapeCharacter(parser->pattern[parser->position++]);
+            }
+            if (high < low) {
+                fprintf(stderr, "Invalid range in the bracket expression of the pattern.\n");
+                parser->status = UNKNOWN_COMMAND;
+                return -1;
+            }
+        }
+        for (int i = low; i <= high; i++) {
+            setAdd(set, (unsigned char) i);
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        parser->nodes[node].set[i] = negated ? ~set[i] : set[i];
+    }
+    if (negated) {
+        // Negated sets must not join lines, only an explicit "\n" matches the new line
+        parser->nodes[node].set['\n' >> 5] &= ~((uint32_t) 1 << ('\n' & 31));
+    }
+    return node;
+}
+
+/**
+ * Appends the node to the end of the chain
+ * @param parser Parser
+ * @param chain Chain
+ * @param node Appended node
+ * @return Execution status
+ */
+static int chainAdd(parser_t *parser, chain_t *chain, int node) {
+    unsigned char height = 0;
+    while (chain->count > 0 && chain->heights[chain->count - 1] == height) {
+        chain->count--;
+        node = astAdd(parser, chain->kind, chain->roots[chain->count], node);
+        if (node < 0) {
+            return BUFFER_ERROR;
+        }
+        height++;
+    }
+    chain->roots[chain->count] = node;
+    chain->heights[chain->count++] = height;
+    return NO_ERROR;
+}
+
+/**
+ * Joins all subtrees of the chain
+ * @param parser Parser
+ * @param chain Chain with at least one node
+ * @return Index of the root, -1 on error
+ */
+static int chainRoot(parser_t *parser, chain_t *chain) {
+    int node = chain->roots[--chain->count];
+    while (node >= 0 && chain->count > 0) {
+        chain->count--;
+        node = astAdd(parser, chain->kind, chain->roots[chain->count], node);
+    }
+    return node;
+}
+
+static int parseAlternation(parser_t *parser);
+
+/**
+ * Parses the atom: a character, a class, an anchor or a group
+ * @param parser Parser
+ * @return Index of the node, -1 on error
+ */
+static int parseAtom(parser_t *parser) {
+    char c = parser->pattern[parser->position++];
+    int node;
+    switch (c) {
+        case '(':
+            if (parser->depth == REGEXP_MAX_DEPTH) {
+                fprintf(stderr, "Parentheses of the pattern are nested deeper than %d.\n", REGEXP_MAX_DEPTH);
+                parser->status = UNKNOWN_COMMAND;
+                return -1;
+            }
+            parser->depth++;
+            node = parseAlternation(parser);
+            parser->depth--;
+            if (node < 0) {
+                return -1;
+            }
+            if (parser->position >= parser->length || parser->pattern[parser->position] != ')') {
+                fprintf(stderr, "Unmatched parenthesis in the pattern.\n");
+                parser->status = UNKNOWN_COMMAND;
+                return -1;
+            }
+            parser->position++;
+            return node;
+        case '[':
+            return parseBracket(parser);
+        case '^':
+            return astAdd(parser, AST_BOL, -1, -1);
+        case '$':
+            return astAdd(parser, AST_EOL, -1, -1);
+        case '*':
+        case '+':
+        case '?':
+            fprintf(stderr, "Nothing to repeat in the pattern.\n");
+            parser->status = UNKNOWN_COMMAND;
+            return -1;
+        default:
+            break;
+    }
+    node = astAdd(parser, AST_SET, -1, -1);
+    if (node < 0) {
+        return -1;
+    }
+    uint32_t *set = parser->nodes[node].set;
+    if (c == '.') {
+        memset(set, 0xff, 8 * sizeof(uint32_t));
+        set['\n' >> 5] &= ~((uint32_t) 1 << ('\n' & 31));
+    } else if (c == '\\') {
+        if (parser->position >= parser->length) {
+            fprintf(stderr, "Trailing backslash in the pattern.\n");
+            parser->status = UNKNOWN_COMMAND;
+            return -1;
+        }
+        c = parser->pattern[parser->position++];
+        if (!setAddClass(set, c)) {
+            setAdd(set, escapeCharacter(c));
+        }
+    } else {
+        setAdd(set, (unsigned char) c);
+    }
+    return node;
+}
+
+/**
+ * Parses the atom followed by repetition operators
+ * @param parser Parser
+ * @return Index of the node, -1 on error
+ */
+static int parseRepeat(parser_t *parser) {
+    int node = parseAtom(parser);
+    while (node >= 0 && parser->position < parser->length) {
+        char c = parser->pattern[parser->position];
+        unsigned char kind;
+        if (c == '*') {
+            kind = AST_STAR;
+        } else if (c == '+') {
+            kind = AST_PLUS;
+        } else if (c == '?') {
+            kind = AST_QUEST;
+        } else {
+            break;
+        }
+        parser->position++;
+        unsigned char inner = parser->nodes[node].kind;
+        if (inner == AST_STAR || inner == AST_PLUS || inner == AST_QUEST) {
+            // A repeated repetition is the same or the star, so repetitions never nest
+            parser->nodes[node].kind = (inner == kind) ? kind : AST_STAR;
+            continue;
+        }
+        node = astAdd(parser, kind, node, -1);
+    }
+    return node;
+}
+
+/**
+ * Parses the concatenation of repeated atoms
+ * @param parser Parser
+ * @return Index of the node, -1 on error
+ */
+static int parseConcat(parser_t *parser) {
+    chain_t chain = {AST_CONCAT, {0}, {0}, 0};
+    while (parser->position < parser->length) {
+        char c = parser->pattern[parser->position];
+        if (c == '|' || c == ')') {
+            break;
+        }
+        int next = parseRepeat(parser);
+        if (next < 0 || chainAdd(parser, &chain, next) != NO_ERROR) {
+            return -1;
+        }
+    }
+    return (chain.count == 0) ? astAdd(parser, AST_EMPTY, -1, -1) : chainRoot(parser, &chain);
+}
+
+/**
+ * Parses alternatives separated by "|"
+ * @param parser Parser
+ * @return Index of the node, -1 on error
+ */
+static int parseAlternation(parser_t *parser) {
+    chain_t chain = {AST_ALTERNATE, {0}, {0}, 0};
+    for (;;) {
+        int node = parseConcat(parser);
+        if (node < 0 || chainAdd(parser, &chain, node) != NO_ERROR) {
+            return -1;
+        }
+        if (parser->position >= parser->length || parser->pattern[parser->position] != '|') {
+            break;
+        }
+        parser->position++;
+    }
+    return chainRoot(parser, &chain);
+}
+
+/**
+ * Adds the state into the NFA
+ * @param nfa NFA
+ * @param capacity Capacity of states
+ * @param kind Kind of the state
+ * @param next Following state
+ * @param alternative Alternative following state
+ * @return Index of the state, -1 on error
+ */
+static int nfaAdd(nfa_t *nfa, int *capacity, unsigned char kind, int next, int alternative) {
+    if (nfa->count == *capacity) {
+        int newCapacity = 2 * *capacity + 16;
+        nfaState_t *states = realloc(nfa->states, (size_t) newCapacity * sizeof(nfaState_t));
+        if (states == NULL) {
+            return -1;
+        }
+        nfa->states = states;
+        *capacity = newCapacity;
+    }
+    nfa->states[nfa->count] = (nfaState_t) {kind, next, alternative, -1};
+    return nfa->count++;
+}
+
+/**
+ * Compiles the syntax tree node in front of the following state
+ * @param nfa NFA
+ * @param capacity Capacity of states
+ * @param nodes Syntax tree
+ * @param node Compiled node
+ * @param next Following state
+ * @param reverse Compile the reversed expression?
+ * @return Initial state of the node, -1 on error
+ */
+static int nfaEmit(nfa_t *nfa, int *capacity, const astNode_t *nodes, int node, int next, bool reverse) {
+    const astNode_t *ast = &nodes[node];
+    int state;
+    int body;
+    switch (ast->kind) {
+        case AST_EMPTY:
+            return next;
+        case AST_SET:
+            state = nfaAdd(nfa, capacity, NFA_SET, next, -1);
+            if (state >= 0) {
+                nfa->states[state].set = ast->left;
+            }
+            return state;
+        case AST_CONCAT:
+            if (reverse) {
+                next = nfaEmit(nfa, capacity, nodes, ast->left, next, reverse);
+                return (next < 0) ? -1 : nfaEmit(nfa, capacity, nodes, ast->right, next, reverse);
+            }
+            next = nfaEmit(nfa, capacity, nodes, ast->right, next, reverse);
+            return (next < 0) ? -1 : nfaEmit(nfa, capacity, nodes, ast->left, next, reverse);
+        case AST_ALTERNATE:
+            state = nfaEmit(nfa, capacity, nodes, ast->left, next, reverse);
+            body = (state < 0) ? -1 : nfaEmit(nfa, capacity, nodes, ast->right, next, reverse);
+            return (body < 0) ? -1 : nfaAdd(nfa, capacity, NFA_SPLIT, state, body);
+        case AST_QUEST:
+            body = nfaEmit(nfa, capacity, nodes, ast->left, next, reverse);
+            return (body < 0) ? -1 : nfaAdd(nfa, capacity, NFA_SPLIT, body, next);
+        case AST_STAR:
+        case AST_PLUS:
+            state = nfaAdd(nfa, capacity, NFA_SPLIT, -1, next);
+            body = (state < 0) ? -1 : nfaEmit(nfa, capacity, nodes, ast->left, state, reverse);
+            if (body < 0) {
+                return -1;
+            }
+            nfa->states[state].next = body;
+            return (ast->kind == AST_STAR) ? state : body;
+        case AST_BOL:
+        case AST_EOL:
+            return nfaAdd(nfa, capacity, ((ast->kind == AST_BOL) != reverse) ? NFA_BOL : NFA_EOL, next, -1);
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Compiles the syntax tree into the NFA
+ * @param nfa NFA
+ * @param parser Parser with the syntax tree
+ * @param root Root of the syntax tree
+ * @param reverse Compile the reversed expression preceded by a loop over any character?
+ * @return Execution status
+ */
+static int nfaCompile(nfa_t *nfa, const parser_t *parser, int root, bool reverse) {
+    memset(nfa, 0, sizeof(*nfa));
+    nfa->setCount = 0;
+    for (int i = 0; i < parser->count; i++) {
+        if (parser->nodes[i].kind == AST_SET) {
+            nfa->setCount++;
+        }
+    }
+    nfa->sets = malloc((size_t) (nfa->setCount + 1) * sizeof(*nfa->sets));
+    if (nfa->sets == NULL) {
+        return BUFFER_ERROR;
+    }
+    // Sets are numbered in the node order, the last one contains any character
+    astNode_t *nodes = malloc((size_t) parser->count * sizeof(astNode_t));
+    if (nodes == NULL) {
+        return BUFFER_ERROR;
+    }
+    memcpy(nodes, parser->nodes, (size_t) parser->count * sizeof(astNode_t));
+    int set = 0;
+    for (int i = 0; i < parser->count; i++) {
+        if (nodes[i].kind == AST_SET) {
+            memcpy(nfa->sets[set], nodes[i].set, sizeof(nodes[i].set));
+            nodes[i].left = set++;
+        }
+    }
+    memset(nfa->sets[set], 0xff, sizeof(nfa->sets[set]));
+    int capacity = 0;
+    int match = nfaAdd(nfa, &capacity, NFA_MATCH, -1, -1);
+    int start = (match < 0) ? -1 : nfaEmit(nfa, &capacity, nodes, root, match, reverse);
+    if (start >= 0 && reverse) {
+        int loop = nfaAdd(nfa, &capacity, NFA_SPLIT, -1, start);
+        int any = (loop < 0) ? -1 : nfaAdd(nfa, &capacity, NFA_SET, loop, -1);
+        if (any >= 0) {
+            nfa->states[any].set = set;
+            nfa->states[loop].next = any;
+        }
+        start = (any < 0) ? -1 : loop;
+    }
+    free(nodes);
+    nfa->start = start;
+    return (start < 0) ? BUFFER_ERROR : NO_ERROR;
+}
+
+/**
+ * Frees the NFA
+ * @param nfa NFA
+ */
+static void nfaFree(nfa_t *nfa) {
+    free(nfa->states);
+    free(nfa->sets);
+    nfa->states = NULL;
+    nfa->sets = NULL;
+    nfa->count = 0;
+}
+
+/**
+ * Compiles the regular expression
+ * @param regexp Compiled regular expression
+ * @param pattern Pattern
+ * @param length Length of the pattern
+ * @return Execution status
+ */
+int regexpCompile(regexp_t *regexp, const char *pattern, size_t length) {
+    memset(regexp, 0, sizeof(*regexp));
+    parser_t parser = {pattern, length, 0, NULL, 0, 0, 0, NO_ERROR};
+    int root = parseAlternation(&parser);
+    if (root >= 0 && parser.position < length) {
+        fprintf(stderr, "Unmatched parenthesis in the pattern.\n");
+        parser.status = UNKNOWN_COMMAND;
+    }
+    int status = parser.status;
+    if (status == NO_ERROR && root < 0) {
+        status = BUFFER_ERROR;
+    }
+    if (status == NO_ERROR) {
+        status = nfaCompile(&regexp->forward, &parser, root, false);
+    }
+    if (status == NO_ERROR) {
+        status = nfaCompile(&regexp->reverse, &parser, root, true);
+    }
+    free(parser.nodes);
+    if (status != NO_ERROR) {
+        regexpFree(regexp);
+    }
+    return status;
+}
+
+/**
+ * Frees the compiled regular expression
+ * @param regexp Compiled regular expression
+ */
+void regexpFree(regexp_t *regexp) {
+    nfaFree(&regexp->forward);
+    nfaFree(&regexp->reverse);
+}
+
+/**
+ * Creates the DFA of the NFA with an empty cache
+ * @param nfa NFA
+ * @return DFA, NULL on error
+ */
+static dfa_t *dfaCreate(const nfa_t *nfa) {
+    dfa_t *dfa = calloc(1, sizeof(dfa_t));
+    if (dfa == NULL) {
+        return NULL;
+    }
+    dfa->nfa = nfa;
+    size_t count = (size_t) nfa->count;
+    dfa->table = malloc(2 * DFA_MAX_STATES * sizeof(int));
+    dfa->visited = calloc(count, sizeof(unsigned int));
+    dfa->stack = malloc((3 * count + 1) * sizeof(int));
+    dfa->work = malloc(count * sizeof(int));
+    dfa->work2 = malloc(count * sizeof(int));
+    if (dfa->table == NULL || dfa->visited == NULL || dfa->stack == NULL || dfa->work == NULL ||
+        dfa->work2 == NULL) {
+        free(dfa->table);
+        free(dfa->visited);
+        free(dfa->stack);
+        free(dfa->work);
+        free(dfa->work2);
+        free(dfa);
+        return NULL;
+    }
+    memset(dfa->table, 0xff, 2 * DFA_MAX_STATES * sizeof(int));
+    dfa->start[0] = dfa->start[1] = DFA_UNKNOWN;
+    return dfa;
+}
+
+/**
+ * Frees the DFA
+ * @param dfa DFA
+ */
+static void dfaFree(dfa_t *dfa) {
+    if (dfa == NULL) {
+        return;
+    }
+    free(dfa->states);
+    free(dfa->pool);
+    free(dfa->table);
+    free(dfa->visited);
+    free(dfa->stack);
+    free(dfa->work);
+    free(dfa->work2);
+    free(dfa);
+}
+
+/**
+ * Drops all cached states of the DFA
+ * @param dfa DFA
+ */
+static void dfaFlush(dfa_t *dfa) {
+    dfa->flushes++;
+    dfa->count = 0;
+    dfa->poolLength = 0;
+    dfa->start[0] = dfa->start[1] = DFA_UNKNOWN;
+    memset(dfa->table, 0xff, 2 * DFA_MAX_STATES * sizeof(int));
+}
+
+/**
+ * Compares NFA state indexes
+ * @param a First index
+ * @param b Second index
+ * @return Comparison result
+ */
+static int compareStates(const void *a, const void *b) {
+    return *(const int *) a - *(const int *) b;
+}
+
+/**
+ * Computes the sorted epsilon closure of the NFA states
+ * Splits are followed, "^" is followed at the start of a line, "$" is followed
+ * only if the closure is expanded at the end of a line, otherwise it is kept
+ * in the set for later.
+ * @param dfa DFA
+ * @param seeds NFA states
+ * @param count Count of NFA states
+ * @param lineStart Is the position at the start of a line?
+ * @param lineEnd Is the position at the end of a line?
+ * @param closure Closure, it may not overlap the seeds
+ * @return Count of NFA states in the closure
+ */
+static int dfaClosure(dfa_t *dfa, const int *seeds, int count, bool lineStart, bool lineEnd, int *closure) {
+    const nfaState_t *states = dfa->nfa->states;
+    if (++dfa->generation == 0) {
+        memset(dfa->visited, 0, (size_t) dfa->nfa->count * sizeof(unsigned int));
+        dfa->generation = 1;
+    }
+    int depth = 0;
+    int size = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        dfa->stack[depth++] = seeds[i];
+    }
+    while (depth > 0) {
+        int state = dfa->stack[--depth];
+        if (state < 0 || dfa->visited[state] == dfa->generation) {
+            continue;
+        }
+        dfa->visited[state] = dfa->generation;
+        const nfaState_t *nfaState = &states[state];
+        switch (nfaState->kind) {
+            case NFA_SPLIT:
+                dfa->stack[depth++] = nfaState->alternative;
+                dfa->stack[depth++] = nfaState->next;
+                break;
+            case NFA_BOL:
+                if (lineStart) {
+                    dfa->stack[depth++] = nfaState->next;
+                }
+                break;
+            case NFA_EOL:
+                if (lineEnd) {
+                    dfa->stack[depth++] = nfaState->next;
+                } else {
+                    closure[size++] = state;
+                }
+                break;
+            default:
+                closure[size++] = state;
+                break;
+        }
+    }
+    qsort(closure, (size_t) size, sizeof(int), compareStates);
+    return size;
+}
+
+/**
+ * Checks if the set contains the accepting NFA state
+ * @param dfa DFA
+ * @param set NFA states
+ * @param count Count of NFA states
+ * @return Does the set accept?
+ */
+static bool dfaAccepts(const dfa_t *dfa, const int *set, int count) {
+    for (int i = 0; i < count; i++) {
+        if (dfa->nfa->states[set[i]].kind == NFA_MATCH) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Finds or adds the DFA state of the NFA state set, the cache is flushed if it is full
+ * @param dfa DFA
+ * @param set Sorted NFA states
+ * @param count Count of NFA states
+ * @param lineStart Is the state at the start of a line?
+ * @return Index of the DFA state, -1 on error
+ */
+static int dfaIntern(dfa_t *dfa, const int *set, int count, bool lineStart) {
+    uint32_t hash = 2166136261u ^ (uint32_t) lineStart;
+    for (int i = 0; i < count; i++) {
+        hash = (hash ^ (uint32_t) set[i]) * 16777619u;
+    }
+    size_t mask = 2 * DFA_MAX_STATES - 1;
+    size_t slot = hash & mask;
+    for (; dfa->table[slot] >= 0; slot = (slot + 1) & mask) {
+        const dfaState_t *state = &dfa->states[dfa->table[slot]];
+        if (state->count == count && state->lineStart == lineStart &&
+            memcmp(dfa->pool + state->set, set, (size_t) count * sizeof(int)) == 0) {
+            return dfa->table[slot];
+        }
+    }
+    if (dfa->count == DFA_MAX_STATES) {
+        dfaFlush(dfa);
+        return dfaIntern(dfa, set, count, lineStart);
+    }
+    if (dfa->count == dfa->capacity) {
+        int capacity = 2 * dfa->capacity + 16;
+        dfaState_t *states = realloc(dfa->states, (size_t) capacity * sizeof(dfaState_t));
+        if (states == NULL) {
+            return -1;
+        }
+        dfa->states = states;
+        dfa->capacity = capacity;
+    }
+    if (dfa->poolLength + (size_t) count > dfa->poolCapacity) {
+        size_t capacity = 2 * dfa->poolCapacity + (size_t) count + 64;
+        int *pool = realloc(dfa->pool, capacity * sizeof(int));
+        if (pool == NULL) {
+            return -1;
+        }
+        dfa->pool = pool;
+        dfa->poolCapacity = capacity;
+    }
+    memcpy(dfa->pool + dfa->poolLength, set, (size_t) count * sizeof(int));
+    dfaState_t *state = &dfa->states[dfa->count];
+    state->set = dfa->poolLength;
+    state->count = count;
+    state->lineStart = lineStart;
+    state->match = dfaAccepts(dfa, set, count);
+    int expanded = dfaClosure(dfa, set, count, lineStart, true, dfa->work2);
+    state->matchEol = dfaAccepts(dfa, dfa->work2, expanded);
+    memset(state->next, 0xff, sizeof(state->next));
+    dfa->poolLength += (size_t) count;
+    dfa->table[slot] = dfa->count;
+    return dfa->count++;
+}
+
+/**
+ * Gets the initial DFA state
+ * @param dfa DFA
+ * @param lineStart Does the search start at the start of a line?
+ * @return Index of the DFA state, -1 on error
+ */
+static int dfaStart(dfa_t *dfa, bool lineStart) {
+    if (dfa->start[lineStart] == DFA_UNKNOWN) {
+        int count = dfaClosure(dfa, &dfa->nfa->start, 1, lineStart, false, dfa->work);
+        int state = dfaIntern(dfa, dfa->work, count, lineStart);
+        // Interning may flush the cache, so the initial state is remembered afterwards
+        dfa->start[lineStart] = state;
+    }
+    return dfa->start[lineStart];
+}
+
+/**
+ * Moves the DFA by the character, the transition is computed if it is not cached
+ * @param dfa DFA
+ * @param state Index of the DFA state
+ * @param c Character
+ * @return Index of the following DFA state, -1 on error
+ */
+static int dfaStep(dfa_t *dfa, int state, unsigned char c) {
+    int next = dfa->states[state].next[c];
+    if (next != DFA_UNKNOWN) {
+        return next;
+    }
+    const dfaState_t *current = &dfa->states[state];
+    const int *set = dfa->pool + current->set;
+    int count = current->count;
+    if (c == '\n') {
+        // "$" matches in front of the new line
+        count = dfaClosure(dfa, set, count, current->lineStart, true, dfa->work2);
+        set = dfa->work2;
+    }
+    int seeds = 0;
+    const nfa_t *nfa = dfa->nfa;
+    for (int i = 0; i < count; i++) {
+        const nfaState_t *nfaState = &nfa->states[set[i]];
+        if (nfaState->kind == NFA_SET && setContains(nfa->sets[nfaState->set], c)) {
+            dfa->stack[seeds++] = nfaState->next;
+        }
+    }
+    memcpy(dfa->work2, dfa->stack, (size_t) seeds * sizeof(int));
+    count = dfaClosure(dfa, dfa->work2, seeds, c == '\n', false, dfa->work);
+    unsigned int flushes = dfa->flushes;
+    next = dfaIntern(dfa, dfa->work, count, c == '\n');
+    if (next >= 0 && dfa->flushes == flushes) {
+        // After a flush the current state does not exist anymore
+        dfa->states[state].next[c] = next;
+    }
+    return next;
+}
+
+/**
+ * Starts a new generation of the table, all remembered pairs are dropped
+ * @param memo Visited pairs
+ * @param flushes Count of DFA cache flushes
+ */
+static void memoInvalidate(memo_t *memo, unsigned int flushes) {
+    if (++memo->generation == 0) {
+        memset(memo->visits, 0, memo->capacity * sizeof(visit_t));
+        memo->generation = 1;
+    }
+    memo->count = 0;
+    memo->runCount = 0;
+    memo->flushes = flushes;
+}
+
+/**
+ * Finds the slot of the pair
+ * @param visits Hash table of pairs
+ * @param capacity Capacity of the table
+ * @param generation Current generation
+ * @param position Position in the text
+ * @param state Index of the DFA state
+ * @return Slot with the pair or an empty slot where it belongs
+ */
+static visit_t *memoSlot(visit_t *visits, size_t capacity, unsigned int generation, size_t position, int state) {
+    uint64_t hash = ((uint64_t) position * 0x9E3779B97F4A7C15u) ^ ((uint64_t) (unsigned int) state * 0xC2B2AE3D27D4EB4Fu);
+    size_t index = (size_t) (hash ^ (hash >> 29)) & (capacity - 1);
+    while (visits[index].generation == generation &&
+           (visits[index].position != position || visits[index].state != state)) {
+        index = (index + 1) & (capacity - 1);
+    }
+    return &visits[index];
+}
+
+/**
+ * Doubles the hash table of pairs
+ * @param memo Visited pairs
+ * @return Has the table grown?
+ */
+static bool memoGrow(memo_t *memo) {
+    size_t capacity = (memo->capacity == 0) ? 1024 : 2 * memo->capacity;
+    if (capacity > 2 * MEMO_MAX_VISITS) {
+        return false;
+    }
+    visit_t *visits = calloc(capacity, sizeof(visit_t));
+    if (visits == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < memo->capacity; i++) {
+        const visit_t *visit = &memo->visits[i];
+        if (visit->generation == memo->generation) {
+            *memoSlot(visits, capacity, memo->generation, visit->position, visit->state) = *visit;
+        }
+    }
+    free(memo->visits);
+    memo->visits = visits;
+    memo->capacity = capacity;
+    return true;
+}
+
+/**
+ * Visits the pair by the current run
+ * @param memo Visited pairs
+ * @param position Position in the text
+ * @param state Index of the DFA state
+ * @return Pair, visited by an earlier run if its run differs, NULL if the table is full
+ */
+static const visit_t *memoVisit(memo_t *memo, size_t position, int state) {
+    if (2 * (memo->count + 1) > memo->capacity && !memoGrow(memo)) {
+        return NULL;
+    }
+    visit_t *visit = memoSlot(memo->visits, memo->capacity, memo->generation, position, state);
+    if (visit->generation != memo->generation) {
+        *visit = (visit_t) {position, state, memo->runCount - 1, memo->generation};
+        memo->count++;
+    }
+    return visit;
+}
+
+/**
+ * Starts a run which remembers its pairs
+ * @param memo Visited pairs
+ * @return Can the run remember its pairs?
+ */
+static bool memoStartRun(memo_t *memo) {
+    if (memo->runCount == memo->runCapacity) {
+        unsigned int capacity = 2 * memo->runCapacity + 64;
+        size_t *ends = realloc(memo->ends, capacity * sizeof(size_t));
+        if (ends == NULL) {
+            return false;
+        }
+        memo->ends = ends;
+        memo->runCapacity = capacity;
+    }
+    memo->ends[memo->runCount++] = MEMO_RUNNING;
+    return true;
+}
+
+/**
+ * Frees the visited pairs
+ * @param memo Visited pairs
+ */
+static void memoFree(memo_t *memo) {
+    if (memo == NULL) {
+        return;
+    }
+    free(memo->visits);
+    free(memo->ends);
+    free(memo);
+}
+
+/**
+ * Gets the length of the text without its terminating new line
+ * The position behind the terminator does not belong to any line, so an empty
+ * match or an anchor found there would add a line to the output.
+ * @param text Text
+ * @param length Length of the text
+ * @return Length of the searched part of the text
+ */
+static size_t searchedLength(const char *text, size_t length) {
+    return (length > 0 && text[length - 1] == '\n') ? length - 1 : length;
+}
+
+/**
+ * Marks all positions of the text where a match of the regular expression starts
+ * The terminating new line of the text is never a part of a match.
+ * @param matcher Matcher of the regular expression
+ * @param regexp Compiled regular expression
+ * @param text Text
+ * @param length Length of the text
+ * @return Execution status
+ */
+int regexpPrepare(regexpMatcher_t *matcher, const regexp_t *regexp, const char *text, size_t length) {
+    length = searchedLength(text, length);
+    if (matcher->forward == NULL) {
+        matcher->forward = dfaCreate(&regexp->forward);
+        matcher->reverse = dfaCreate(&regexp->reverse);
+        matcher->memo = calloc(1, sizeof(memo_t));
+        if (matcher->forward == NULL || matcher->reverse == NULL || matcher->memo == NULL) {
+            return BUFFER_ERROR;
+        }
+    }
+    memoInvalidate(matcher->memo, matcher->forward->flushes);
+    matcher->memo->scanned = 0;
+    matcher->memo->limit = 2 * length + 256;
+    if (length + 1 > matcher->capacity) {
+        size_t capacity = 2 * length + 64;
+        unsigned char *marks = realloc(matcher->marks, capacity);
+        if (marks == NULL) {
+            return BUFFER_ERROR;
+        }
+        matcher->marks = marks;
+        matcher->capacity = capacity;
+    }
+    dfa_t *dfa = matcher->reverse;
+    int state = dfaStart(dfa, true);
+    for (size_t i = length;; i--) {
+        if (state < 0) {
+            return BUFFER_ERROR;
+        }
+        const dfaState_t *current = &dfa->states[state];
+        bool lineEnd = (i == 0) || text[i - 1] == '\n';
+        matcher->marks[i] = current->match || (lineEnd && current->matchEol);
+        if (i == 0) {
+            break;
+        }
+        state = dfaStep(dfa, state, (unsigned char) text[i - 1]);
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Finds the end of the longest match starting at the position
+ * @param dfa Forward DFA
+ * @param memo Pairs visited by earlier runs on the text
+ * @param text Text
+ * @param length Length of the text
+ * @param start Start of the match
+ * @return End of the match, start if only the empty match exists
+ */
+static size_t dfaLongest(dfa_t *dfa, memo_t *memo, const char *text, size_t length, size_t start) {
+    int state = dfaStart(dfa, start == 0 || text[start - 1] == '\n');
+    bool remember = memo->scanned > memo->limit && memoStartRun(memo);
+    unsigned int run = memo->runCount - 1;
+    size_t end = start;
+    for (size_t i = start; state >= 0; i++) {
+        if (remember) {
+            if (dfa->flushes != memo->flushes) {
+                // Indexes of DFA states have changed, so the pairs do not describe them anymore
+                memoInvalidate(memo, dfa->flushes);
+                remember = memoStartRun(memo);
+                run = memo->runCount - 1;
+            }
+            const visit_t *visit = remember ? memoVisit(memo, i, state) : NULL;
+            if (visit != NULL && visit->run != run) {
+                // The earlier run continued from here in the same way
+                size_t known = memo->ends[visit->run];
+                if (known != MEMO_RUNNING && known >= i && known > end) {
+                    end = known;
+                }
+                break;
+            }
+        }
+        const dfaState_t *current = &dfa->states[state];
+        bool lineEnd = (i == length) || text[i] == '\n';
+        if (current->match || (lineEnd && current->matchEol)) {
+            end = i;
+        }
+        if (i == length || current->count == 0) {
+            break;
+        }
+        state = dfaStep(dfa, state, (unsigned char) text[i]);
+        memo->scanned++;
+    }
+    if (remember) {
+        memo->ends[run] = end;
+    }
+    return end;
+}
+
+/**
+ * Finds the leftmost-longest match behind the position, the text has to be prepared by regexpPrepare
+ * @param matcher Matcher of the regular expression
+ * @param text Text
+ * @param length Length of the text
+ * @param from Position where the search starts
+ * @param start Start of the match
+ * @param end End of the match
+ * @return Has a match been found?
+ */
+bool regexpFind(regexpMatcher_t *matcher, const char *text, size_t length, size_t from, size_t *start, size_t *end) {
+    length = searchedLength(text, length);
+    if (from > length) {
+        return false;
+    }
+    const unsigned char *mark = memchr(matcher->marks + from, 1, length + 1 - from);
+    if (mark == NULL) {
+        return false;
+    }
+    *start = (size_t) (mark - matcher->marks);
+    *end = dfaLongest(matcher->forward, matcher->memo, text, length, *start);
+    return true;
+}
+
+/**
+ * Frees DFA caches of the matcher
+ * @param matcher Matcher of the regular expression
+ */
+void regexpMatcherFree(regexpMatcher_t *matcher) {
+    dfaFree(matcher->forward);
+    dfaFree(matcher->reverse);
+    memoFree(matcher->memo);
+    free(matcher->marks);
+    memset(matcher, 0, sizeof(*matcher));
+}
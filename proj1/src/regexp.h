@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * State of the Thompson NFA
+ */
+typedef struct {
+    /// Kind of the state
+    unsigned char kind;
+    /// Following state
+    int next;
+    /// Alternative following state (split)
+    int alternative;
+    /// Index of the character set (set)
+    int set;
+} nfaState_t;
+
+/**
+ * Thompson NFA
+ */
+typedef struct {
+    /// States
+    nfaState_t *states;
+    /// Count of states
+    int count;
+    /// Character sets, 256 bits each
+    uint32_t (*sets)[8];
+    /// Count of character sets
+    int setCount;
+    /// Initial state
+    int start;
+} nfa_t;
+
+/**
+ * Compiled regular expression
+ */
+typedef struct {
+    /// NFA of the expression
+    nfa_t forward;
+    /// NFA of the reversed expression preceded by a loop over any character
+    nfa_t reverse;
+} regexp_t;
+
+/**
+ * Lazily built DFA, the states are created when the search needs them
+ */
+typedef struct dfa dfa_t;
+
+/**
+ * Pairs of positions and DFA states visited by longest-match runs
+ */
+typedef struct memo memo_t;
+
+/**
+ * Matcher of a regular expression with its DFA caches, each thread needs its own matcher
+ */
+typedef struct {
+    /// DFA of the expression, finds the longest match from its start
+    dfa_t *forward;
+    /// DFA of the reversed expression, finds all starts of matches
+    dfa_t *reverse;
+    /// Pairs visited by longest-match runs on the prepared text
+    memo_t *memo;
+    /// Marks of positions where a match starts
+    unsigned char *marks;
+    /// Capacity of the marks
+    size_t capacity;
+} regexpMatcher_t;
+
+int regexpCompile(regexp_t *regexp, const char *pattern, size_t length);
+
+void regexpFree(regexp_t *regexp);
+
+int regexpPrepare(regexpMatcher_t *matcher, const regexp_t *regexp, const char *text, size_t length);
+
+bool regexpFind(regexpMatcher_t *matcher, const char *text, size_t length, size_t from, size_t *start, size_t *end);
+
+void regexpMatcherFree(regexpMatcher_t *matcher);
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Literal pattern searchers. The pattern is analysed once and the searcher is
+ * reused for every line: single characters are found by memchr, short
+ * patterns by comparing the first and the last character of 16 windows at
+ * once with SSE2 (candidates are verified by memcmp) and long patterns by the
+ * Boyer-Moore-Horspool algorithm, which skips up to the length of the pattern.
+ */
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "search.h"
+
+/**
+ * Compiles the searcher of the pattern
+ * @param searcher Searcher
+ * @param pattern Pattern, must outlive the searcher
+ * @param length Length of the pattern
+ */
+void searchCompile(searcher_t *searcher, const char *pattern, size_t length) {
+    searcher->pattern = pattern;
+    searcher->length = length;
+    if (length == 0) {
+        searcher->kind = SEARCH_EMPTY;
+    } else if (length == 1) {
+        searcher->kind = SEARCH_BYTE;
+    } else if (length < SEARCH_HORSPOOL_MIN) {
+        searcher->kind = SEARCH_SHORT;
+    } else {
+        searcher->kind = SEARCH_HORSPOOL;
+        uint32_t shift = (length > UINT32_MAX) ? UINT32_MAX : (uint32_t) length;
+        for (int i = 0; i < 256; i++) {
+            searcher->shift[i] = shift;
+        }
+        for (size_t i = 0; i + 1 < length; i++) {
+            size_t distance = length - 1 - i;
+            searcher->shift[(unsigned char) pattern[i]] = (distance > UINT32_MAX) ? UINT32_MAX : (uint32_t) distance;
+        }
+    }
+}
+
+/**
+ * Finds the short pattern by its first and last character
+ * @param searcher Searcher
+ * @param text Searched text
+ * @param last Last possible position of the occurrence
+ * @param from Position where the search starts
+ * @return Position of the occurrence or SEARCH_NONE
+ */
+static size_t searchShort(const searcher_t *searcher, const char *text, size_t last, size_t from) {
+    const char *pattern = searcher->pattern;
+    size_t length = searcher->length;
+    size_t i = from;
+#ifdef __SSE2__
+    __m128i first = _mm_set1_epi8(pattern[0]);
+    __m128i lastCharacter = _mm_set1_epi8(pattern[length - 1]);
+    for (; i + 16 <= last + 1; i += 16) {
+        __m128i head = _mm_loadu_si128((const __m128i *) (text + i));
+        __m128i tail = _mm_loadu_si128((const __m128i *) (text + i + length - 1));
+        unsigned int mask = (unsigned int) _mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, lastCharacter)));
+        while (mask != 0) {
+            size_t position = i + (size_t) __builtin_ctz(mask);
+            if (memcmp(text + position + 1, pattern + 1, length - 2) == 0) {
+                return position;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (i <= last) {
+        const char *p = memchr(text + i, pattern[0], last + 1 - i);
+        if (p == NULL) {
+            break;
+        }
+        i = (size_t) (p - text);
+        if (p[length - 1] == pattern[length - 1] && memcmp(p + 1, pattern + 1, length - 2) == 0) {
+            return i;
+        }
+        i++;
+    }
+    return SEARCH_NONE;
+}
+
+/**
+ * Finds the long pattern by the Boyer-Moore-Horspool algorithm
+ * @param searcher Searcher
+ * @param text Searched text
+ * @param last Last possible position of the occurrence
+ * @param from Position where the search starts
+ * @return Position of the occurrence or SEARCH_NONE
+ */
+static size_t searchHorspool(const searcher_t *searcher, const char *text, size_t last, size_t from) {
+    const char *pattern = searcher->pattern;
+    size_t length = searcher->length;
+    unsigned char lastCharacter = (unsigned char) pattern[length - 1];
+    for (size_t i = from; i <= last;) {
+        unsigned char c = (unsigned char) text[i + length - 1];
+        if (c == lastCharacter && memcmp(text + i, pattern, length - 1) == 0) {
+            return i;
+        }
+        i += searcher->shift[c];
+    }
+    return SEARCH_NONE;
+}
+
+/**
+ * Finds the first occurrence of the pattern
+ * @param searcher Searcher
+ * @param text Searched text
+ * @param length Length of the text
+ * @param from Position where the search starts
+ * @return Position of the occurrence or SEARCH_NONE
+ */
+size_t searchFind(const searcher_t *searcher, const char *text, size_t length, size_t from) {
+    if (from > length || length - from < searcher->length) {
+        return SEARCH_NONE;
+    }
+    size_t last = length - searcher->length;
+    switch (searcher->kind) {
+        case SEARCH_EMPTY:
+            return from;
+        case SEARCH_BYTE: {
+            const char *p = memchr(text + from, searcher->pattern[0], length - from);
+            return (p == NULL) ? SEARCH_NONE : (size_t) (p - text);
+        }
+        case SEARCH_SHORT:
+            return searchShort(searcher, text, last, from);
+        default:
+            return searchHorspool(searcher, text, last, from);
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Position of the pattern which does not occur in the text
+#define SEARCH_NONE ((size_t) -1)
+/// Shortest pattern searched by the Boyer-Moore-Horspool algorithm
+#define SEARCH_HORSPOOL_MIN 64
+
+/**
+ * Search algorithms
+ */
+enum searchKinds {
+    /// Empty pattern matches everywhere
+    SEARCH_EMPTY,
+    /// One character, memchr
+    SEARCH_BYTE,
+    /// Short pattern, filtering of candidates by the first and the last character
+    SEARCH_SHORT,
+    /// Long pattern, Boyer-Moore-Horspool
+    SEARCH_HORSPOOL,
+};
+
+/**
+ * Precompiled searcher of a literal pattern
+ */
+typedef struct {
+    /// Search algorithm
+    enum searchKinds kind;
+    /// Pattern
+    const char *pattern;
+    /// Length of the pattern
+    size_t length;
+    /// Shifts of the Boyer-Moore-Horspool algorithm indexed by the last character of the window
+    uint32_t shift[256];
+} searcher_t;
+
+void searchCompile(searcher_t *searcher, const char *pattern, size_t length);
+
+size_t searchFind(const searcher_t *searcher, const char *text, size_t length, size_t from);
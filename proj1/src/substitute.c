@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Substitution engine. All pending patterns are matched in one left-to-right
+ * pass over the line: the engine keeps the next match of every pattern, takes
+ * the leftmost one (the earlier command wins ties), copies the text before it
+ * and the replacement into the output buffer and continues behind the match.
+ * The replacements are never searched again, so S is linear in the length of
+ * the line and it terminates even if the replacement contains the pattern.
+ * A pattern of the s command is dropped after its first replacement. Regular
+ * expressions take part in the same pass with their leftmost-longest matches,
+ * an empty match right behind a match of the same pattern is skipped.
+ *
+ * Lines assembled from fragments (the texts of a and b around the input line)
+ * are substituted fragment by fragment, they are copied only if a pattern
+ * occurs across a boundary of fragments.
+ *
+ * The sequential engine keeps the original semantics, where every command
+ * rewrites the result of the previous one.
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "proj1.h"
+#include "search.h"
+#include "substitute.h"
+
+/**
+ * Opens the per-thread state of substitutions
+ * @param context State of substitutions
+ * @param regexpCount Count of regular expressions in the program
+ * @return Execution status
+ */
+int substituteContextOpen(substituteContext_t *context, size_t regexpCount) {
+    context->count = regexpCount;
+    context->scratch = (buffer_t) {NULL, 0, 0};
+    context->matchers = NULL;
+    if (regexpCount > 0) {
+        context->matchers = calloc(regexpCount, sizeof(regexpMatcher_t));
+        if (context->matchers == NULL) {
+            context->count = 0;
+            return BUFFER_ERROR;
+        }
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Closes the per-thread state of substitutions
+ * @param context State of substitutions
+ */
+void substituteContextClose(substituteContext_t *context) {
+    for (size_t i = 0; i < context->count; i++) {
+        regexpMatcherFree(&context->matchers[i]);
+    }
+    free(context->matchers);
+    bufferFree(&context->scratch);
+    context->matchers = NULL;
+    context->count = 0;
+}
+
+/**
+ * Finds the next match of the pattern
+ * @param cmd Substitution command
+ * @param context State of substitutions
+ * @param text Line, prepared for regular expressions
+ * @param length Length of the line
+ * @param from Position where the search starts
+ * @param match Start and end of the match, start is SEARCH_NONE if there is no match
+ */
+static void findMatch(const instruction_t *cmd, substituteContext_t *context, const char *text, size_t length,
+                      size_t from, size_t match[2]) {
+    if (cmd->regexp != NULL) {
+        if (!regexpFind(&context->matchers[cmd->regexpIndex], text, length, from, &match[0], &match[1])) {
+            match[0] = SEARCH_NONE;
+        }
+        return;
+    }
+    match[0] = searchFind(&cmd->searcher, text, length, from);
+    match[1] = match[0] + cmd->textLength;
+}
+
+/**
+ * Applies all substitution commands in one pass over the part of the line
+ * @param commands Substitution commands
+ * @param context State of substitutions
+ * @param text Part of the line
+ * @param length Length of the part
+ * @param done Flags of s commands which have already replaced their match in previous parts
+ * @param output Buffer the substituted part is appended to
+ * @return Execution status
+ */
+static int applyPass(const substituteCmds_t *commands, substituteContext_t *context, const char *text, size_t length,
+                     bool done[COMMAND_SIZE], buffer_t *output) {
+    size_t next[COMMAND_SIZE][2];
+    for (int i = 0; i < commands->count; i++) {
+        const instruction_t *cmd = commands->cmds[i];
+        if (done[i]) {
+            next[i][0] = SEARCH_NONE;
+            continue;
+        }
+        if (cmd->regexp != NULL &&
+            regexpPrepare(&context->matchers[cmd->regexpIndex], cmd->regexp, text, length) != NO_ERROR) {
+            return BUFFER_ERROR;
+        }
+        findMatch(cmd, context, text, length, 0, next[i]);
+    }
+    size_t position = 0;
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < commands->count; i++) {
+            if (next[i][0] != SEARCH_NONE && (best < 0 || next[i][0] < next[best][0])) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        const instruction_t *cmd = commands->cmds[best];
+        if (bufferAppend(output, text + position, next[best][0] - position) ||
+            bufferAppend(output, cmd->replacement, cmd->replacementLength)) {
+            return BUFFER_ERROR;
+        }
+        position = next[best][1];
+        if (cmd->cmd == CMD_SUBSTITUTE) {
+            next[best][0] = SEARCH_NONE;
+            done[best] = true;
+        } else {
+            findMatch(cmd, context, text, length, position, next[best]);
+            if (next[best][0] == position && next[best][1] == position) {
+                // Empty matches right behind a match are skipped, so S always moves forward
+                findMatch(cmd, context, text, length, position + 1, next[best]);
+            }
+        }
+        for (int i = 0; i < commands->count; i++) {
+            if (next[i][0] != SEARCH_NONE && next[i][0] < position) {
+                findMatch(commands->cmds[i], context, text, length, position, next[i]);
+            }
+        }
+    }
+    return bufferAppend(output, text + position, length - position);
+}
+
+/**
+ * Applies all substitution commands in one pass
+ * @param commands Substitution commands
+ * @param context State of substitutions
+ * @param text Line
+ * @param length Length of the line
+ * @param output Buffer the substituted line is appended to
+ * @return Execution status
+ */
+int substituteApply(const substituteCmds_t *commands, substituteContext_t *context, const char *text, size_t length,
+                    buffer_t *output) {
+    bool done[COMMAND_SIZE] = {false};
+    return applyPass(commands, context, text, length, done, output);
+}
+
+/**
+ * Checks if the fragment consists of new lines only
+ * Literal patterns come from lines of the script, so they never contain a new
+ * line and they can neither occur in such fragment nor across it.
+ * @param fragment Fragment
+ * @return Are all characters new lines?
+ */
+static bool newLinesOnly(const struct iovec *fragment) {
+    const char *data = fragment->iov_base;
+    for (size_t i = 0; i < fragment->iov_len; i++) {
+        if (data[i] != '\n') {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Checks if a pattern may occur across the boundary between the characters
+ * @param commands Substitution commands
+ * @param last Last character in front of the boundary
+ * @param first First character behind the boundary
+ * @return May some pattern contain both characters next to each other?
+ */
+static bool mayCross(const substituteCmds_t *commands, char last, char first) {
+    for (int i = 0; i < commands->count; i++) {
+        const char *pattern = commands->cmds[i]->text;
+        for (size_t k = 1; k < commands->cmds[i]->textLength; k++) {
+            if (pattern[k - 1] == last && pattern[k] == first) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks if a pattern occurs across the boundary in front of the fragment
+ * The text around the boundary is copied into the window, which is as long as
+ * the longest pattern on both sides of the boundary.
+ * @param commands Substitution commands
+ * @param fragments Fragments of the line
+ * @param count Count of fragments
+ * @param right Index of the fragment behind the boundary
+ * @param reach Length of the longest pattern without one character
+ * @param window Buffer for the window
+ * @return Does a pattern occur across the boundary?
+ */
+static bool crossesBoundary(const substituteCmds_t *commands, const struct iovec *fragments, size_t count,
+                            size_t right, size_t reach, buffer_t *window) {
+    size_t first = right;
+    size_t taken = 0;
+    while (first > 0 && taken < reach) {
+        taken += fragments[--first].iov_len;
+    }
+    size_t skip = (taken > reach) ? taken - reach : 0;
+    bufferClear(window);
+    for (size_t i = first; i < right; i++) {
+        if (bufferAppend(window, (const char *) fragments[i].iov_base + skip, fragments[i].iov_len - skip)) {
+            return true;
+        }
+        skip = 0;
+    }
+    size_t boundary = window->length;
+    for (size_t i = right; i < count && window->length < boundary + reach; i++) {
+        size_t length = boundary + reach - window->length;
+        if (length > fragments[i].iov_len) {
+            length = fragments[i].iov_len;
+        }
+        if (bufferAppend(window, fragments[i].iov_base, length)) {
+            return true;
+        }
+    }
+    for (int i = 0; i < commands->count; i++) {
+        size_t length = commands->cmds[i]->textLength;
+        if (length < 2) {
+            continue;
+        }
+        size_t from = (boundary + 1 > length) ? boundary + 1 - length : 0;
+        size_t position = searchFind(&commands->cmds[i]->searcher, window->data, window->length, from);
+        if (position != SEARCH_NONE && position < boundary) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Checks that no pattern occurs across a boundary of the fragments
+ * Regular expressions may match across any distance, so they are never
+ * separable.
+ * @param commands Substitution commands
+ * @param fragments Fragments of the line
+ * @param count Count of fragments
+ * @param window Buffer for windows around boundaries
+ * @return Can the fragments be substituted one by one?
+ */
+static bool fragmentsSeparable(const substituteCmds_t *commands, const struct iovec *fragments, size_t count,
+                               buffer_t *window) {
+    size_t longest = 0;
+    for (int i = 0; i < commands->count; i++) {
+        if (commands->cmds[i]->regexp != NULL) {
+            return false;
+        }
+        if (commands->cmds[i]->textLength > longest) {
+            longest = commands->cmds[i]->textLength;
+        }
+    }
+    if (longest < 2) {
+        return true;
+    }
+    const char *last = NULL;
+    for (size_t i = 0; i < count; i++) {
+        if (fragments[i].iov_len == 0) {
+            continue;
+        }
+        if (newLinesOnly(&fragments[i])) {
+            last = NULL;
+            continue;
+        }
+        const char *data = fragments[i].iov_base;
+        if (last != NULL && mayCross(commands, *last, data[0]) &&
+            crossesBoundary(commands, fragments, count, i, longest - 1, window)) {
+            return false;
+        }
+        last = data + fragments[i].iov_len - 1;
+    }
+    return true;
+}
+
+/**
+ * Applies all substitution commands in one pass over the line given by fragments
+ * The fragments are substituted one by one, unless a pattern occurs across
+ * their boundary, then the line is assembled in the scratch buffer first.
+ * @param commands Substitution commands
+ * @param context State of substitutions
+ * @param fragments Fragments of the line
+ * @param count Count of fragments
+ * @param output Buffer the substituted line is appended to
+ * @return Execution status
+ */
+int substituteApplyFragments(const substituteCmds_t *commands, substituteContext_t *context,
+                             const struct iovec *fragments, size_t count, buffer_t *output) {
+    bool done[COMMAND_SIZE] = {false};
+    if (fragmentsSeparable(commands, fragments, count, &context->scratch)) {
+        // An empty pattern of s matches in front of the first fragment, even if it is empty
+        bool empty = false;
+        for (int i = 0; i < commands->count; i++) {
+            empty = empty || commands->cmds[i]->textLength == 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            int status;
+            if ((i > 0 || !empty) && newLinesOnly(&fragments[i])) {
+                status = bufferAppend(output, fragments[i].iov_base, fragments[i].iov_len);
+            } else {
+                status = applyPass(commands, context, fragments[i].iov_base, fragments[i].iov_len, done, output);
+            }
+            if (status != NO_ERROR) {
+                return BUFFER_ERROR;
+            }
+        }
+        return NO_ERROR;
+    }
+    bufferClear(&context->scratch);
+    for (size_t i = 0; i < count; i++) {
+        if (bufferAppend(&context->scratch, fragments[i].iov_base, fragments[i].iov_len)) {
+            return BUFFER_ERROR;
+        }
+    }
+    return applyPass(commands, context, context->scratch.data, context->scratch.length, done, output);
+}
+
+/**
+ * Replaces the first occurrence of the pattern behind the position
+ * @param buffer Line
+ * @param cmd Substitution command
+ * @param from Position where the search starts, moved behind the replacement
+ * @return Execution status
+ */
+static int replaceNext(buffer_t *buffer, const instruction_t *cmd, size_t *from) {
+    size_t position = searchFind(&cmd->searcher, buffer->data, buffer->length, *from);
+    if (position == SEARCH_NONE) {
+        return NOT_FOUND;
+    }
+    *from = position + cmd->replacementLength;
+    return bufferReplace(buffer, position, cmd->textLength, cmd->replacement, cmd->replacementLength);
+}
+
+/**
+ * Applies substitution commands one after another
+ * S repeats the replacement from the beginning of the line until the pattern
+ * disappears, if its replacement contains the pattern (which would never
+ * disappear), every occurrence is replaced once. A regular expression may
+ * match its own replacement in ways which cannot be detected, so every match
+ * of S with a regular expression is replaced once.
+ * @param commands Substitution commands
+ * @param context State of substitutions
+ * @param buffer Line, substituted in place
+ * @return Execution status
+ */
+int substituteApplySequential(const substituteCmds_t *commands, substituteContext_t *context, buffer_t *buffer) {
+    for (int i = 0; i < commands->count; i++) {
+        const instruction_t *cmd = commands->cmds[i];
+        if (cmd->regexp != NULL) {
+            substituteCmds_t single = {1, {cmd}};
+            bufferClear(&context->scratch);
+            if (substituteApply(&single, context, buffer->data, buffer->length, &context->scratch) != NO_ERROR) {
+                return BUFFER_ERROR;
+            }
+            buffer_t substituted = context->scratch;
+            context->scratch = *buffer;
+            *buffer = substituted;
+            continue;
+        }
+        bool once = searchFind(&cmd->searcher, cmd->replacement, cmd->replacementLength, 0) != SEARCH_NONE;
+        size_t from = 0;
+        int status = replaceNext(buffer, cmd, &from);
+        while (cmd->cmd == CMD_SUBSTITUTE_ALL && status == NO_ERROR) {
+            if (!once) {
+                from = 0;
+            }
+            status = replaceNext(buffer, cmd, &from);
+        }
+        if (status == BUFFER_ERROR) {
+            return BUFFER_ERROR;
+        }
+    }
+    return NO_ERROR;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "buffer.h"
+#include "program.h"
+#include "regexp.h"
+
+/// Maximal count of pending substitution commands
+#define COMMAND_SIZE 16
+
+/**
+ * Structure for substitution commands
+ */
+typedef struct {
+    int count;
+    const instruction_t *cmds[COMMAND_SIZE];
+} substituteCmds_t;
+
+/**
+ * Per-thread state of substitutions
+ */
+typedef struct {
+    /// Matchers of regular expressions indexed by the regexp index of the instruction
+    regexpMatcher_t *matchers;
+    /// Count of matchers
+    size_t count;
+    /// Buffer for sequential substitutions by regular expressions and for assembled lines
+    buffer_t scratch;
+} substituteContext_t;
+
+int substituteContextOpen(substituteContext_t *context, size_t regexpCount);
+
+void substituteContextClose(substituteContext_t *context);
+
+int substituteApply(const substituteCmds_t *commands, substituteContext_t *context, const char *text, size_t length,
+                    buffer_t *output);
+
+int substituteApplyFragments(const substituteCmds_t *commands, substituteContext_t *context,
+                             const struct iovec *fragments, size_t count, buffer_t *output);
+
+int substituteApplySequential(const substituteCmds_t *commands, substituteContext_t *context, buffer_t *buffer);
@@ -18,3 +18,18 @@ echo "=================================================== 0.25^2.5 =============
 ./../bin/proj2 --pow 0.25 2.5 1
 echo "===================================================== 2^10 ====================================================="
 ./../bin/proj2 --pow 2 10 100
+
+echo "============================================== ln(1e-6), fast engine ==========================================="
+./../bin/proj2 --fast --log 1e-6 40
+echo "=============================================== 1e-6^4.2, fast engine =========================================="
+./../bin/proj2 --fast --pow 1e-6 4.2 40
+echo "================================================= batch, 2 threads ============================================="
+printf "taylor_log 2 40\ncfrac_log 2 40\ntaylor_pow 1.23 4.2 40\ntaylorcf_pow 1.23 4.2 40\nfast_log 2\nfast_pow 1.23 4.2\n" | ./../bin/proj2 --batch 2
+echo "============================================ batch, 100000 threads requested ==================================="
+printf "taylor_log 2 40\n" | ./../bin/proj2 --batch 100000
+echo "================================================== table of ln(x) =============================================="
+./../bin/proj2 --table 1 2 0.125 40
+echo "================================================== table of x^2.5 =============================================="
+./../bin/proj2 --table 1 2 0.125 40 2.5
+echo "============================================ ln(100) to 1e-12 tolerance ========================================="
+./../bin/proj2 --log-eps 100 1e-12 1000
@@ -0,0 +1,364 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Multithreaded batch evaluation of queries.
+ *
+ * Every input line holds one query "FUNCTION X [Y] [N]", for example
+ * "taylor_log 2 40" or "fast_pow 1.23 4.2". Blocks of whole lines read from
+ * the input descriptor go through the shared ordered ring, so results come
+ * out in the order of queries. Results of invalid queries are NaN, they are
+ * counted and reported once at the end.
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "fastmath.h"
+#include "proj2.h"
+#include "ring.h"
+#include "series.h"
+
+/// Maximal length of the formatted result
+#define RESULT_SIZE 32
+
+/**
+ * Function evaluated by the query
+ */
+typedef struct {
+    /// Name of the function
+    const char *name;
+    /// Count of real arguments
+    int arity;
+    /// Does the function take the count of iterations?
+    bool iterations;
+    /// Natural logarithm kernel
+    double (*log)(double, unsigned int);
+    /// Power function kernel
+    double (*pow)(double, double, unsigned int);
+    /// Table-driven natural logarithm
+    double (*fastLog)(double);
+    /// Table-driven power function
+    double (*fastPow)(double, double);
+} query_t;
+
+/**
+ * Block of queries and their results
+ */
+typedef struct {
+    /// Queries, the last one ends the block or the input
+    char *input;
+    /// Length of the queries
+    size_t inputLength;
+    /// Capacity of the query buffer
+    size_t inputCapacity;
+    /// Formatted results
+    char *output;
+    /// Length of the formatted results
+    size_t outputLength;
+    /// Capacity of the output buffer
+    size_t outputCapacity;
+    /// Count of invalid queries in the block
+    size_t errors;
+} block_t;
+
+/**
+ * Argument of callbacks of the ring
+ */
+typedef struct {
+    /// Input file descriptor
+    int inputFd;
+    /// Output file descriptor
+    int outputFd;
+    /// Preferred size of the block
+    size_t chunkSize;
+    /// Incomplete line read after the last block
+    char *carry;
+    /// Length of the incomplete line
+    size_t carryLength;
+    /// Has the input ended?
+    bool eof;
+    /// Count of invalid queries written so far
+    size_t errors;
+} batch_t;
+
+/// Supported functions
+static const query_t queries[] = {
+    {"taylor_log", 1, true, taylor_log, NULL, NULL, NULL},
+    {"cfrac_log", 1, true, cfrac_log, NULL, NULL, NULL},
+    {"taylor_pow", 2, true, NULL, taylor_pow, NULL, NULL},
+    {"taylorcf_pow", 2, true, NULL, taylorcf_pow, NULL, NULL},
+    {"fast_log", 1, false, NULL, NULL, fast_log, NULL},
+    {"fast_pow", 2, false, NULL, NULL, NULL, fast_pow},
+};
+
+/**
+ * Skips white spaces (except the end of line)
+ * @param string String
+ * @return First non-white character
+ */
+static char *skipSpaces(char *string) {
+    while (*string == ' ' || *string == '\t' || *string == '\r') {
+        string++;
+    }
+    return string;
+}
+
+/**
+ * Evaluates one query
+ * @param line Query terminated by NUL
+ * @param result Result
+ * @return Execution status
+ */
+static int evaluateQuery(char *line, double *result) {
+    char *token = skipSpaces(line);
+    size_t length = strcspn(token, " \t\r");
+    const query_t *query = NULL;
+    for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); i++) {
+        if (strlen(queries[i].name) == length && strncmp(queries[i].name, token, length) == 0) {
+            query = &queries[i];
+            break;
+        }
+    }
+    if (query == NULL) {
+        return CONVERSION_ERROR;
+    }
+    char *endptr = token + length;
+    double arguments[2];
+    for (int i = 0; i < query->arity; i++) {
+        token = endptr;
+        arguments[i] = strtod(token, &endptr);
+        if (endptr == token) {
+            return CONVERSION_ERROR;
+        }
+    }
+    unsigned long n = 0;
+    if (query->iterations) {
+        token = skipSpaces(endptr);
+        n = strtoul(token, &endptr, 10);
+        if (endptr == token) {
+            return CONVERSION_ERROR;
+        }
+    }
+    if (*skipSpaces(endptr) != '\0') {
+        return CONVERSION_ERROR;
+    }
+    if (query->log != NULL) {
+        *result = query->log(arguments[0], (unsigned int) n);
+    } else if (query->pow != NULL) {
+        *result = query->pow(arguments[0], arguments[1], (unsigned int) n);
+    } else if (query->fastLog != NULL) {
+        *result = query->fastLog(arguments[0]);
+    } else {
+        *result = query->fastPow(arguments[0], arguments[1]);
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Evaluates all queries of the block into its output buffer
+ * @param argument Batch evaluation
+ * @param local Unused
+ * @param slot Block of queries
+ * @return Execution status
+ */
+static int evaluateBlock(void *argument, void *local, void *slot) {
+    (void) argument;
+    (void) local;
+    block_t *block = slot;
+    char *line = block->input;
+    char *end = block->input + block->inputLength;
+    block->outputLength = 0;
+    block->errors = 0;
+    while (line < end) {
+        char *newLine = memchr(line, '\n', end - line);
+        if (newLine == NULL) {
+            newLine = end;
+        }
+        *newLine = '\0';
+        if (block->outputCapacity - block->outputLength < RESULT_SIZE) {
+            size_t capacity = 2 * block->outputCapacity + RESULT_SIZE;
+            char *output = realloc(block->output, capacity);
+            if (output == NULL) {
+                return ALLOCATION_ERROR;
+            }
+            block->output = output;
+            block->outputCapacity = capacity;
+        }
+        double result;
+        if (evaluateQuery(line, &result) != NO_ERROR) {
+            result = NAN;
+            block->errors++;
+        }
+        block->outputLength += snprintf(block->output + block->outputLength, RESULT_SIZE, "%.12g\n", result);
+        line = newLine + 1;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Writes the whole buffer into the file descriptor
+ * @param fd File descriptor
+ * @param buffer Buffer
+ * @param length Length of the buffer
+ * @return Execution status
+ */
+static int writeAll(int fd, const char *buffer, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, buffer, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("proj2");
+            return WRITE_ERROR;
+        }
+        buffer += written;
+        length -= written;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Writes results of the block and counts its invalid queries
+ * @param argument Batch evaluation
+ * @param slot Evaluated block
+ * @return Execution status
+ */
+static int writeBlock(void *argument, void *slot) {
+    batch_t *batch = argument;
+    const block_t *block = slot;
+    batch->errors += block->errors;
+    return writeAll(batch->outputFd, block->output, block->outputLength);
+}
+
+/**
+ * Reads the next block of complete lines
+ * The incomplete last line is kept in the carry buffer for the next block.
+ * @param argument Batch evaluation
+ * @param slot Block to fill
+ * @param end Set when there is no other query
+ * @return Execution status
+ */
+static int readBlock(void *argument, void *slot, bool *end) {
+    batch_t *batch = argument;
+    block_t *block = slot;
+    if (batch->eof && batch->carryLength == 0) {
+        *end = true;
+        return NO_ERROR;
+    }
+    size_t capacity = (batch->carryLength > batch->chunkSize) ? 2 * batch->carryLength : batch->chunkSize;
+    if (block->inputCapacity < capacity + 1) {
+        char *input = realloc(block->input, capacity + 1);
+        if (input == NULL) {
+            return ALLOCATION_ERROR;
+        }
+        block->input = input;
+        block->inputCapacity = capacity + 1;
+    }
+    memcpy(block->input, batch->carry, batch->carryLength);
+    block->inputLength = batch->carryLength;
+    char *lastNewLine = NULL;
+    while (!batch->eof) {
+        if (block->inputLength == block->inputCapacity - 1) {
+            if (lastNewLine != NULL) {
+                break;
+            }
+            // A single line longer than the block
+            char *input = realloc(block->input, 2 * block->inputCapacity);
+            if (input == NULL) {
+                return ALLOCATION_ERROR;
+            }
+            block->input = input;
+            block->inputCapacity *= 2;
+        }
+        ssize_t length = read(batch->inputFd, block->input + block->inputLength,
+                              block->inputCapacity - 1 - block->inputLength);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("proj2");
+            return READ_ERROR;
+        }
+        if (length == 0) {
+            batch->eof = true;
+            break;
+        }
+        char *newLine = block->input + block->inputLength;
+        block->inputLength += length;
+        while ((newLine = memchr(newLine, '\n', block->input + block->inputLength - newLine)) != NULL) {
+            lastNewLine = newLine++;
+        }
+    }
+    size_t complete = block->inputLength;
+    if (!batch->eof) {
+        complete = lastNewLine + 1 - block->input;
+    }
+    batch->carryLength = block->inputLength - complete;
+    if (batch->carryLength > 0) {
+        char *carry = realloc(batch->carry, batch->carryLength);
+        if (carry == NULL) {
+            return ALLOCATION_ERROR;
+        }
+        batch->carry = carry;
+        memcpy(batch->carry, block->input + complete, batch->carryLength);
+    }
+    block->inputLength = complete;
+    *end = (complete == 0);
+    return NO_ERROR;
+}
+
+/**
+ * Frees buffers of the block
+ * @param slot Block
+ */
+static void freeBlock(void *slot) {
+    block_t *block = slot;
+    free(block->input);
+    free(block->output);
+}
+
+/**
+ * Evaluates queries from the input and writes results in the input order
+ * @param inputFd Input file descriptor
+ * @param outputFd Output file descriptor
+ * @param threads Count of worker threads, 0 for the count of processors, at most RING_MAX_THREADS
+ * @param chunkSize Preferred size of the block of queries
+ * @return Execution status
+ */
+int batchEvaluate(int inputFd, int outputFd, unsigned int threads, size_t chunkSize) {
+    batch_t batch = {inputFd, outputFd, chunkSize, NULL, 0, false, 0};
+    ring_t ring = {sizeof(block_t), 0, &batch, ALLOCATION_ERROR, THREAD_ERROR, readBlock, evaluateBlock,
+                   writeBlock, NULL, NULL, freeBlock};
+    int status = ringExecute(&ring, threads);
+    free(batch.carry);
+    if (status == NO_ERROR && batch.errors > 0) {
+        fprintf(stderr, "Invalid queries: %zu.\n", batch.errors);
+        status = CONVERSION_ERROR;
+    }
+    return status;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>
+
+/// Default size of the input chunk in bytes
+#define BATCH_CHUNK_SIZE (1 << 20)
+
+int batchEvaluate(int inputFd, int outputFd, unsigned int threads, size_t chunkSize);
@@ -0,0 +1,411 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Accuracy and throughput benchmark of the natural logarithm and power
+ * function kernels. Sweeps X (and Y for power functions) over log-spaced
+ * ranges and iteration counts and reports time per call and errors in ULPs
+ * against libm, followed by iteration counts needed to reach the relative
+ * error of 1e-12.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "convert.h"
+#include "fastmath.h"
+#include "proj2.h"
+#include "series.h"
+
+/// Required relative error for the convergence report
+#define TOLERANCE 1e-12
+/// Maximal count of sampled values of X or Y
+#define MAX_POINTS 1024
+
+/**
+ * Output formats
+ */
+enum formats {
+    FORMAT_CSV,
+    FORMAT_JSON,
+};
+
+/**
+ * Benchmarked kernel
+ */
+typedef struct {
+    /// Name of the kernel
+    const char *name;
+    /// Natural logarithm kernel, NULL for power function kernels
+    double (*log)(double, unsigned int);
+    /// Power function kernel, NULL for natural logarithm kernels
+    double (*pow)(double, double, unsigned int);
+    /// Maximal count of iterations searched by the convergence report
+    unsigned int maxIterations;
+} kernel_t;
+
+/**
+ * Benchmark settings
+ */
+typedef struct {
+    /// Sampled values of X
+    double x[MAX_POINTS];
+    /// Count of sampled values of X
+    unsigned int xCount;
+    /// Sampled values of Y
+    double y[MAX_POINTS];
+    /// Count of sampled values of Y
+    unsigned int yCount;
+    /// Largest benchmarked count of iterations
+    unsigned int maxN;
+    /// Count of repeats of the timed sweep
+    unsigned int repeats;
+    /// Output format
+    enum formats format;
+} settings_t;
+
+/**
+ * Accumulated errors of one sweep
+ */
+typedef struct {
+    /// Time per call in nanoseconds
+    double nsPerCall;
+    /// Maximal error in ULPs
+    double maxUlp;
+    /// Mean error in ULPs
+    double meanUlp;
+} result_t;
+
+/// Sink for the computed values, so the compiler cannot omit the calls
+volatile double sink;
+
+/**
+ * Returns current monotonic time
+ * @return Time in nanoseconds
+ */
+double now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+/**
+ * Calculates the error of the value in ULPs of the reference value
+ * @param value Calculated value
+ * @param reference Reference value
+ * @return Error in ULPs
+ */
+double ulpError(double value, double reference) {
+    if (value == reference || (isnan(value) && isnan(reference))) {
+        return 0;
+    }
+    if (!isfinite(value) || !isfinite(reference)) {
+        return INFINITY;
+    }
+    double ulp = nextafter(fabs(reference), INFINITY) - fabs(reference);
+    return fabs(value - reference) / ulp;
+}
+
+/**
+ * Checks if the value has the required relative error
+ * @param value Calculated value
+ * @param reference Reference value
+ * @return Is the value precise enough?
+ */
+bool isPrecise(double value, double reference) {
+    if (value == reference) {
+        return true;
+    }
+    return fabs(value - reference) <= TOLERANCE * fabs(reference);
+}
+
+/**
+ * Fills the array with log-spaced values
+ * @param values Array of values
+ * @param count Count of values
+ * @param min Smallest absolute value
+ * @param max Largest absolute value
+ * @param bothSigns Interleave positive and negative values
+ */
+void logSpace(double *values, unsigned int count, double min, double max, bool bothSigns) {
+    unsigned int steps = bothSigns ? (count + 1) / 2 : count;
+    double step = (steps > 1) ? (log(max) - log(min)) / (steps - 1) : 0;
+    for (unsigned int i = 0; i < count; i++) {
+        double value = exp(log(min) + (bothSigns ? i / 2 : i) * step);
+        values[i] = (bothSigns && (i % 2 == 1)) ? -value : value;
+    }
+}
+
+/**
+ * Runs one sweep of the kernel over all sampled values
+ * @param kernel Benchmarked kernel
+ * @param settings Benchmark settings
+ * @param n Count of iterations
+ * @return Sweep result
+ */
+result_t sweep(const kernel_t *kernel, const settings_t *settings, unsigned int n) {
+    result_t result = {0, 0, 0};
+    unsigned int calls = 0;
+    double sum = 0;
+    double start = now();
+    for (unsigned int r = 0; r < settings->repeats; r++) {
+        for (unsigned int i = 0; i < settings->xCount; i++) {
+            if (kernel->log != NULL) {
+                sum += kernel->log(settings->x[i], n);
+                calls++;
+                continue;
+            }
+            for (unsigned int j = 0; j < settings->yCount; j++) {
+                sum += kernel->pow(settings->x[i], settings->y[j], n);
+                calls++;
+            }
+        }
+    }
+    result.nsPerCall = (now() - start) / calls;
+    sink = sum;
+    calls = 0;
+    for (unsigned int i = 0; i < settings->xCount; i++) {
+        for (unsigned int j = 0; j < ((kernel->log != NULL) ? 1 : settings->yCount); j++) {
+            double error;
+            if (kernel->log != NULL) {
+                error = ulpError(kernel->log(settings->x[i], n), log(settings->x[i]));
+            } else {
+                error = ulpError(kernel->pow(settings->x[i], settings->y[j], n), pow(settings->x[i], settings->y[j]));
+            }
+            result.maxUlp = fmax(result.maxUlp, error);
+            result.meanUlp += error;
+            calls++;
+        }
+    }
+    result.meanUlp /= calls;
+    return result;
+}
+
+/**
+ * Evaluates the kernel and checks if the result is precise enough
+ * @param kernel Kernel
+ * @param x Value of X
+ * @param y Value of Y
+ * @param n Count of iterations
+ * @return Is the result precise enough?
+ */
+bool converged(const kernel_t *kernel, double x, double y, unsigned int n) {
+    if (kernel->log != NULL) {
+        return isPrecise(kernel->log(x, n), log(x));
+    }
+    return isPrecise(kernel->pow(x, y, n), pow(x, y));
+}
+
+/**
+ * Finds the count of iterations needed to reach the required relative error
+ * Doubles the count of iterations and then bisects, it expects the error to
+ * stay within the tolerance once it has been reached.
+ * @param kernel Kernel
+ * @param x Value of X
+ * @param y Value of Y
+ * @return Count of iterations or 0 if the tolerance has not been reached
+ */
+unsigned int iterationsNeeded(const kernel_t *kernel, double x, double y) {
+    unsigned int high = 1;
+    while (!converged(kernel, x, y, high)) {
+        if (high >= kernel->maxIterations) {
+            return 0;
+        }
+        high *= 2;
+    }
+    unsigned int low = high / 2;
+    while (high - low > 1) {
+        unsigned int middle = low + (high - low) / 2;
+        if (converged(kernel, x, y, middle)) {
+            high = middle;
+        } else {
+            low = middle;
+        }
+    }
+    return high;
+}
+
+/**
+ * Prints the sweep results
+ * @param kernels Kernels
+ * @param count Count of kernels
+ * @param settings Benchmark settings
+ */
+void printSweeps(const kernel_t *kernels, unsigned int count, const settings_t *settings) {
+    bool first = true;
+    if (settings->format == FORMAT_CSV) {
+        puts("function,n,ns_per_call,max_ulp,mean_ulp");
+    } else {
+        printf("{\n  \"sweeps\": [");
+    }
+    for (unsigned int k = 0; k < count; k++) {
+        for (unsigned int n = 1; n <= settings->maxN; n *= 2) {
+            result_t result = sweep(&kernels[k], settings, n);
+            if (settings->format == FORMAT_CSV) {
+                printf("%s,%u,%.3f,%.6g,%.6g\n", kernels[k].name, n, result.nsPerCall, result.maxUlp, result.meanUlp);
+            } else {
+                printf("%s\n    {\"function\": \"%s\", \"n\": %u, \"ns_per_call\": %.3f, ", first ? "" : ",",
+                       kernels[k].name, n, result.nsPerCall);
+                // JSON has no infinity, so infinite errors are reported as null
+                printf(isinf(result.maxUlp) ? "\"max_ulp\": null, " : "\"max_ulp\": %.6g, ", result.maxUlp);
+                printf(isinf(result.meanUlp) ? "\"mean_ulp\": null}" : "\"mean_ulp\": %.6g}", result.meanUlp);
+            }
+            first = false;
+            if (n > settings->maxN / 2) {
+                // Doubling n would pass maxN, or wrap around to 0 for maxN above 2^31
+                break;
+            }
+        }
+    }
+    if (settings->format == FORMAT_JSON) {
+        printf("\n  ],\n");
+    }
+}
+
+/**
+ * Prints the iteration counts needed to reach the required relative error
+ * @param kernels Kernels
+ * @param count Count of kernels
+ * @param settings Benchmark settings
+ */
+void printConvergence(const kernel_t *kernels, unsigned int count, const settings_t *settings) {
+    bool first = true;
+    if (settings->format == FORMAT_CSV) {
+        puts("\nfunction,x,y,n_for_1e-12");
+    } else {
+        printf("  \"convergence\": [");
+    }
+    for (unsigned int k = 0; k < count; k++) {
+        for (unsigned int i = 0; i < settings->xCount; i++) {
+            for (unsigned int j = 0; j < ((kernels[k].log != NULL) ? 1 : settings->yCount); j++) {
+                double y = (kernels[k].log != NULL) ? NAN : settings->y[j];
+                unsigned int n = iterationsNeeded(&kernels[k], settings->x[i], y);
+                if (settings->format == FORMAT_CSV) {
+                    printf("%s,%.17g,%.17g,%u\n", kernels[k].name, settings->x[i], y, n);
+                } else {
+                    printf("%s\n    {\"function\": \"%s\", \"x\": %.17g, ", first ? "" : ",", kernels[k].name,
+                           settings->x[i]);
+                    printf(isnan(y) ? "\"y\": null, " : "\"y\": %.17g, ", y);
+                    printf(n == 0 ? "\"n\": null}" : "\"n\": %u}", n);
+                }
+                first = false;
+            }
+        }
+    }
+    if (settings->format == FORMAT_JSON) {
+        printf("\n  ]\n}\n");
+    }
+}
+
+/**
+ * Parses the sampled range
+ * @param argv Arguments MIN MAX COUNT
+ * @param values Sampled values
+ * @param count Count of sampled values
+ * @param bothSigns Sample also negative values
+ * @return Execution status
+ */
+int parseRange(char *argv[], double *values, unsigned int *count, bool bothSigns) {
+    double min, max;
+    if (strToDouble(argv[0], &min) || strToDouble(argv[1], &max) || strToUInt(argv[2], count)) {
+        return CONVERSION_ERROR;
+    }
+    if (!(min > 0) || !(max >= min) || *count == 0 || *count > MAX_POINTS) {
+        fprintf(stderr, "Invalid range, expected 0 < MIN <= MAX and 0 < COUNT <= %d.\n", MAX_POINTS);
+        return ARGUMENT_ERROR;
+    }
+    logSpace(values, *count, min, max, bothSigns);
+    return NO_ERROR;
+}
+
+/**
+ * Prints program's usage
+ * @return Execution status
+ */
+int printUsage() {
+    puts("Usage: ./proj2bench [options]");
+    puts("Options:");
+    puts("\t--csv\t\t\tPrints results as CSV (default)");
+    puts("\t--json\t\t\tPrints results as JSON");
+    puts("\t--x MIN MAX COUNT\tSamples COUNT log-spaced values of X (default 1e-3 1e3 25)");
+    puts("\t--y MIN MAX COUNT\tSamples COUNT log-spaced values of |Y| of both signs (default 0.1 10 8)");
+    puts("\t--max-n N\t\tBenchmarks iteration counts 1, 2, 4, ... up to N (default 64)");
+    puts("\t--repeats R\t\tRepeats each timed sweep R times (default 100)");
+    puts("\t-h, --help\t\tPrints help (this message) and exits");
+    return NO_ERROR;
+}
+
+/**
+ * Main program function
+ * @param argc Count of arguments
+ * @param argv Program's arguments
+ * @return Execution status
+ */
+int main(int argc, char *argv[]) {
+    static settings_t settings;
+    settings.maxN = 64;
+    settings.repeats = 100;
+    settings.format = FORMAT_CSV;
+    settings.xCount = 25;
+    logSpace(settings.x, settings.xCount, 1e-3, 1e3, false);
+    settings.yCount = 8;
+    logSpace(settings.y, settings.yCount, 0.1, 10, true);
+    for (int i = 1; i < argc; i++) {
+        int status = NO_ERROR;
+        if (strcmp(argv[i], "--csv") == 0) {
+            settings.format = FORMAT_CSV;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            settings.format = FORMAT_JSON;
+        } else if (strcmp(argv[i], "--x") == 0 && i + 3 < argc) {
+            status = parseRange(&argv[i + 1], settings.x, &settings.xCount, false);
+            i += 3;
+        } else if (strcmp(argv[i], "--y") == 0 && i + 3 < argc) {
+            status = parseRange(&argv[i + 1], settings.y, &settings.yCount, true);
+            i += 3;
+        } else if (strcmp(argv[i], "--max-n") == 0 && i + 1 < argc) {
+            status = strToUInt(argv[++i], &settings.maxN);
+        } else if (strcmp(argv[i], "--repeats") == 0 && i + 1 < argc) {
+            status = strToUInt(argv[++i], &settings.repeats);
+        } else {
+            printUsage();
+            return (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) ? NO_ERROR : ARGUMENT_ERROR;
+        }
+        if (status != NO_ERROR) {
+            return status;
+        }
+    }
+    if (settings.repeats == 0) {
+        settings.repeats = 1;
+    }
+    const kernel_t kernels[] = {
+        {"taylor_log", taylor_log, NULL, 1u << 20},
+        {"cfrac_log", cfrac_log, NULL, 1u << 20},
+        {"taylor_pow", NULL, taylor_pow, 1u << 10},
+        {"taylorcf_pow", NULL, taylorcf_pow, 1u << 10},
+    };
+    unsigned int count = sizeof(kernels) / sizeof(kernels[0]);
+    printSweeps(kernels, count, &settings);
+    printConvergence(kernels, count, &settings);
+    return NO_ERROR;
+}
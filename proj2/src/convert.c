@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Conversions of command line arguments shared by proj2 and proj2bench. Both
+ * report a failed conversion on stderr, callers only pass the status on.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "convert.h"
+#include "proj2.h"
+
+/**
+ * Converts string into double
+ * @param string String to convert
+ * @param number Converted double
+ * @return Execution status
+ */
+int strToDouble(char *string, double *number) {
+    char *endptr;
+    *number = strtod(string, &endptr);
+    if (*endptr != '\0') {
+        fprintf(stderr, "Error in string conversion to double.\n");
+        return CONVERSION_ERROR;
+    }
+    return NO_ERROR;
+}
+
+/**
+ * Converts string into unsigned integer
+ * @param string String to convert
+ * @param number Converted unsigned integer
+ * @return Execution status
+ */
+int strToUInt(char *string, unsigned int *number) {
+    char *endptr;
+    *number = (unsigned int) strtoul(string, &endptr, 10);
+    if (*endptr != '\0') {
+        fprintf(stderr, "Error in string conversion to unsigned int.\n");
+        return CONVERSION_ERROR;
+    }
+    return NO_ERROR;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+int strToDouble(char *string, double *number);
+
+int strToUInt(char *string, unsigned int *number);
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "fastmath.h"
+#include "fastmathImpl.h"
+
+/**
+ * Calculates the natural logarithm via a lookup table and a polynomial
+ * @param x Value whose logarithm is calculated
+ * @return Natural logarithm
+ */
+double fast_log(double x) {
+    return fastLog(x);
+}
+
+/**
+ * Calculates the exponential function via a lookup table and a polynomial
+ * @param x Value whose exponential function is calculated
+ * @return Exponential function
+ */
+double fast_exp(double x) {
+    return fastExp(x);
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @return Value of the power function of Y with a base X
+ */
+double fast_pow(double x, double y) {
+    return fastPow(x, y);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+/// Count of bits of the mantissa used for the logarithm table index
+#define FAST_LOG_TABLE_BITS 7
+/// Count of entries in the logarithm table
+#define FAST_LOG_TABLE_SIZE (1 << FAST_LOG_TABLE_BITS)
+/// Binary representation of the lower bound of the reduced logarithm argument (0.6875)
+#define FAST_LOG_OFFSET UINT64_C(0x3fe6000000000000)
+/// Degree of the polynomial approximating log(1 + r)
+#define FAST_LOG_POLY_DEGREE 8
+
+/// Count of bits of the exponential table index
+#define FAST_EXP_TABLE_BITS 7
+/// Count of entries in the exponential table
+#define FAST_EXP_TABLE_SIZE (1 << FAST_EXP_TABLE_BITS)
+/// Degree of the polynomial approximating exp(r)
+#define FAST_EXP_POLY_DEGREE 5
+
+double fast_log(double x);
+
+double fast_exp(double x);
+
+double fast_pow(double x, double y);
@@ -0,0 +1,253 @@
+/*
+ * Table-driven natural logarithm, exponential and power functions.
+ *
+ * log(x): x = 2^k * z, z is approximated by the table point c, so
+ *         log(x) = k * ln(2) + log(c) + log(1 + (z - c) / c),
+ *         where the last term is a low-degree polynomial.
+ * exp(x): x = (k * N + j) * ln(2) / N + r, so
+ *         exp(x) = 2^k * 2^(j / N) * exp(r),
+ *         where 2^(j / N) is from the table and exp(r) is a polynomial.
+ * pow(x, y) = exp(y * log(x)), the logarithm is evaluated with an extra tail
+ * to keep the precision for large results.
+ *
+ * Tables and coefficients are generated by genTables at build time. The
+ * functions are inline, so they can be embedded via proj2math.h, fastmath.c
+ * provides them as fast_log, fast_exp and fast_pow.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "fastmath.h"
+#include "fastmathTables.h"
+
+/// Binary representation of the smallest positive normal double
+#define FAST_SMALLEST_NORMAL UINT64_C(0x0010000000000000)
+/// Binary representation of the positive infinity
+#define FAST_POSITIVE_INFINITY UINT64_C(0x7ff0000000000000)
+
+/**
+ * Converts double into its binary representation
+ * @param x Double
+ * @return Binary representation
+ */
+static inline uint64_t fastAsUInt64(double x) {
+    uint64_t i;
+    memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+/**
+ * Converts binary representation into double
+ * @param i Binary representation
+ * @return Double
+ */
+static inline double fastAsDouble(uint64_t i) {
+    double x;
+    memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+/**
+ * Calculates the sum of two doubles and its rounding error
+ * @param a First summand
+ * @param b Second summand
+ * @param error Rounding error of the sum
+ * @return Rounded sum
+ */
+static inline double fastTwoSum(double a, double b, double *error) {
+    double sum = a + b;
+    double bVirtual = sum - a;
+    *error = (a - (sum - bVirtual)) + (b - bVirtual);
+    return sum;
+}
+
+/**
+ * Calculates the product of two doubles and its rounding error
+ * @param a First factor
+ * @param b Second factor
+ * @param error Rounding error of the product
+ * @return Rounded product
+ */
+static inline double fastTwoProduct(double a, double b, double *error) {
+    double product = a * b;
+#ifdef FP_FAST_FMA
+    *error = fma(a, b, -product);
+#else
+    const double splitter = 0x1p27 + 1;
+    double aSplit = splitter * a;
+    double aHigh = aSplit - (aSplit - a);
+    double aLow = a - aHigh;
+    double bSplit = splitter * b;
+    double bHigh = bSplit - (bSplit - b);
+    double bLow = b - bHigh;
+    *error = ((aHigh * bHigh - product) + aHigh * bLow + aLow * bHigh) + aLow * bLow;
+#endif
+    return product;
+}
+
+/**
+ * Calculates the natural logarithm of positive normal number
+ * @param ix Binary representation of the number
+ * @param tail Tail of the natural logarithm
+ * @return Natural logarithm
+ */
+static inline double fastLogCore(uint64_t ix, double *tail) {
+    uint64_t tmp = ix - FAST_LOG_OFFSET;
+    int i = (int) ((tmp >> (52 - FAST_LOG_TABLE_BITS)) % FAST_LOG_TABLE_SIZE);
+    double k = (double) ((int64_t) tmp >> 52);
+    double z = fastAsDouble(ix - (tmp & (UINT64_C(0xfff) << 52)));
+    double r = (z - fastLogTable[i].c) * fastLogTable[i].invc;
+    double poly = fastLogPoly[FAST_LOG_POLY_DEGREE - 2];
+    for (int j = FAST_LOG_POLY_DEGREE - 3; j >= 0; j--) {
+        poly = poly * r + fastLogPoly[j];
+    }
+    double tableError, sumError;
+    double w = fastTwoSum(k * fastLn2, fastLogTable[i].logc, &tableError);
+    double high = fastTwoSum(w, r, &sumError);
+    double low = tableError + sumError + k * fastLn2Tail + fastLogTable[i].logcTail + r * r * poly;
+    double result = high + low;
+    *tail = (high - result) + low;
+    return result;
+}
+
+/**
+ * Calculates the exponential function of the number with a tail
+ * @param x Value whose exponential function is calculated
+ * @param tail Tail of the value
+ * @return Exponential function
+ */
+static inline double fastExpCore(double x, double tail) {
+    const double shift = 0x1.8p52;
+    bool extreme = !(fabs(x) < 708);
+    if (extreme) {
+        if (isnan(x) || x > 709.79) {
+            return x + INFINITY;
+        }
+        if (x < -745.14) {
+            return 0;
+        }
+    }
+    double kd = x * fastInvLn2N + shift;
+    int64_t n = (int64_t) (fastAsUInt64(kd) - fastAsUInt64(shift));
+    kd -= shift;
+    double r = x - kd * fastLn2N - kd * fastLn2NTail + tail;
+    int j = (int) (n & (FAST_EXP_TABLE_SIZE - 1));
+    int64_t k = (n - j) / FAST_EXP_TABLE_SIZE;
+    double poly = fastExpPoly[FAST_EXP_POLY_DEGREE - 2];
+    for (int i = FAST_EXP_POLY_DEGREE - 3; i >= 0; i--) {
+        poly = poly * r + fastExpPoly[i];
+    }
+    poly = r + r * r * poly;
+    if (extreme) {
+        return ldexp(fastExpTable[j] + fastExpTable[j] * poly, (int) k);
+    }
+    double scale = fastAsDouble(fastAsUInt64(fastExpTable[j]) + ((uint64_t) k << 52));
+    return scale + scale * poly;
+}
+
+/**
+ * Checks the parity of the integer value
+ * @param y Value
+ * @return -1 for non-integer value, 0 for even value and 1 for odd value
+ */
+static inline int fastIntegerParity(double y) {
+    if (trunc(y) != y) {
+        return -1;
+    }
+    if (fabs(y) >= 0x1p53) {
+        return 0;
+    }
+    return (int) ((int64_t) y & 1);
+}
+
+/**
+ * Calculates the natural logarithm via a lookup table and a polynomial
+ * @param x Value whose logarithm is calculated
+ * @return Natural logarithm
+ */
+static inline double fastLog(double x) {
+    uint64_t ix = fastAsUInt64(x);
+    if (ix - FAST_SMALLEST_NORMAL >= FAST_POSITIVE_INFINITY - FAST_SMALLEST_NORMAL) {
+        if (x == 0) {
+            return -INFINITY;
+        }
+        if (isnan(x) || x < 0) {
+            return NAN;
+        }
+        if (isinf(x)) {
+            return INFINITY;
+        }
+        // Subnormal number
+        ix = fastAsUInt64(x * 0x1p52) - (UINT64_C(52) << 52);
+    }
+    double tail;
+    return fastLogCore(ix, &tail);
+}
+
+/**
+ * Calculates the exponential function via a lookup table and a polynomial
+ * @param x Value whose exponential function is calculated
+ * @return Exponential function
+ */
+static inline double fastExp(double x) {
+    return fastExpCore(x, 0);
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @return Value of the power function of Y with a base X
+ */
+static inline double fastPow(double x, double y) {
+    if (y == 0 || x == 1) {
+        return 1;
+    }
+    if (isnan(x) || isnan(y)) {
+        return x + y;
+    }
+    if (isinf(y)) {
+        double base = fabs(x);
+        if (base == 1) {
+            return 1;
+        }
+        return ((base > 1) == (y > 0)) ? INFINITY : 0;
+    }
+    bool negative = false;
+    if (signbit(x)) {
+        int parity = fastIntegerParity(y);
+        if (parity < 0 && x != 0) {
+            return NAN;
+        }
+        negative = (parity == 1);
+        x = -x;
+    }
+    double result;
+    if (x == 0) {
+        result = (y < 0) ? INFINITY : 0;
+    } else if (isinf(x)) {
+        result = (y < 0) ? 0 : INFINITY;
+    } else {
+        uint64_t ix = fastAsUInt64(x);
+        if (ix < FAST_SMALLEST_NORMAL) {
+            ix = fastAsUInt64(x * 0x1p52) - (UINT64_C(52) << 52);
+        }
+        double logTail, tail;
+        double logarithm = fastLogCore(ix, &logTail);
+        double exponent;
+        if (fabs(y) < 0x1p900) {
+            exponent = fastTwoProduct(y, logarithm, &tail);
+            tail += y * logTail;
+        } else {
+            exponent = y * logarithm;
+            tail = 0;
+        }
+        result = fastExpCore(exponent, tail);
+    }
+    return negative ? -result : result;
+}
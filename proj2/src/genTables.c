@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Build-time generator of the lookup tables and polynomial coefficients used
+ * by the fast logarithm and exponential engine (fastmath.c). All values are
+ * computed in long double and printed as exact hexadecimal double literals,
+ * so the engine does not need any initialization at run time.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fastmath.h"
+
+/// Maximal supported degree of the fitted polynomials
+#define MAX_DEGREE 16
+
+/**
+ * Exit codes
+ */
+enum exitStatuses {
+    NO_ERROR,
+    FILE_WRITE_ERROR,
+};
+
+/**
+ * Converts double into its binary representation
+ * @param x Double
+ * @return Binary representation
+ */
+uint64_t asUInt64(double x) {
+    uint64_t i;
+    memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+/**
+ * Converts binary representation into double
+ * @param i Binary representation
+ * @return Double
+ */
+double asDouble(uint64_t i) {
+    double x;
+    memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+/**
+ * Calculates (log(1 + r) - r) / r^2 via a Taylor series in long double
+ * @param r Value near zero
+ * @return Value of the function
+ */
+long double log1pTail(long double r) {
+    long double sum = 0;
+    long double power = 1;
+    for (int i = 2; i < 64; i++) {
+        sum += ((i % 2 == 0) ? -power : power) / i;
+        power *= r;
+    }
+    return sum;
+}
+
+/**
+ * Calculates (exp(r) - 1 - r) / r^2 via a Taylor series in long double
+ * @param r Value near zero
+ * @return Value of the function
+ */
+long double expm1Tail(long double r) {
+    long double sum = 0;
+    long double term = 0.5L;
+    for (int i = 2; i < 32; i++) {
+        sum += term;
+        term *= r / (i + 1);
+    }
+    return sum;
+}
+
+/**
+ * Fits polynomial to the function on the symmetric interval [-range, range]
+ * Interpolates the function in Chebyshev nodes, which gives nearly minimax
+ * polynomial, and converts the result into the monomial basis.
+ * @param f Fitted function
+ * @param range Half-width of the interval
+ * @param degree Degree of the polynomial
+ * @param coefficients Coefficients of the polynomial (lowest power first)
+ */
+void chebyshevFit(long double (*f)(long double), long double range, int degree, long double *coefficients) {
+    int nodes = degree + 1;
+    long double cheb[MAX_DEGREE + 1] = {0};
+    for (int j = 0; j < nodes; j++) {
+        for (int k = 0; k < nodes; k++) {
+            long double angle = acosl(-1) * (k + 0.5L) / nodes;
+            cheb[j] += f(range * cosl(angle)) * cosl(j * angle);
+        }
+        cheb[j] *= 2.0L / nodes;
+    }
+    cheb[0] /= 2;
+    // T_{j+1}(t) = 2t T_j(t) - T_{j-1}(t)
+    long double previous[MAX_DEGREE + 1] = {1};
+    long double current[MAX_DEGREE + 1] = {0, 1};
+    memset(coefficients, 0, sizeof(long double) * nodes);
+    coefficients[0] = cheb[0];
+    for (int j = 1; j < nodes; j++) {
+        for (int i = 0; i <= j; i++) {
+            coefficients[i] += cheb[j] * current[i];
+        }
+        long double next[MAX_DEGREE + 1] = {0};
+        for (int i = 0; i <= j; i++) {
+            next[i + 1] += 2 * current[i];
+            next[i] -= previous[i];
+        }
+        memcpy(previous, current, sizeof(previous));
+        memcpy(current, next, sizeof(current));
+    }
+    long double scale = 1;
+    for (int i = 0; i < nodes; i++) {
+        coefficients[i] /= scale;
+        scale *= range;
+    }
+}
+
+/**
+ * Splits long double into the double with trailing zero bits and its tail
+ * @param value Value to split
+ * @param bits Count of significant bits of the head
+ * @param tail Tail of the value
+ * @return Head of the value
+ */
+double splitHead(long double value, int bits, double *tail) {
+    uint64_t mask = ~((UINT64_C(1) << (52 - bits + 1)) - 1);
+    double head = asDouble(asUInt64((double) value) & mask);
+    *tail = (double) (value - head);
+    return head;
+}
+
+/**
+ * Prints polynomial coefficients as an array
+ * @param file Output file
+ * @param name Name of the array
+ * @param coefficients Coefficients
+ * @param from Index of the first printed coefficient
+ * @param to Index of the last printed coefficient
+ */
+void printPolynomial(FILE *file, const char *name, long double *coefficients, int from, int to) {
+    fprintf(file, "static const double %s[%d] = {\n", name, to - from + 1);
+    for (int i = from; i <= to; i++) {
+        fprintf(file, "    %a,\n", (double) coefficients[i]);
+    }
+    fprintf(file, "};\n\n");
+}
+
+/**
+ * Prints table for the natural logarithm
+ * The table splits reduced arguments z from [OFF, 2 * OFF) into subintervals
+ * indexed by top bits of the mantissa. Subintervals neighbouring 1 use c = 1,
+ * so there is no cancellation for the arguments near 1.
+ * @param file Output file
+ */
+void printLogTable(FILE *file) {
+    fprintf(file, "static const struct {\n    double c;\n    double invc;\n    double logc;\n    double logcTail;\n"
+                  "} fastLogTable[%d] = {\n", FAST_LOG_TABLE_SIZE);
+    uint64_t step = UINT64_C(1) << (52 - FAST_LOG_TABLE_BITS);
+    for (uint64_t i = 0; i < FAST_LOG_TABLE_SIZE; i++) {
+        double low = asDouble(FAST_LOG_OFFSET + i * step);
+        double high = asDouble(FAST_LOG_OFFSET + (i + 1) * step);
+        double c = (low + high) / 2;
+        if (low == 1 || high == 1) {
+            c = 1;
+        }
+        long double logc = logl(c);
+        double logcHead = (double) logc;
+        fprintf(file, "    {%a, %a, %a, %a},\n", c, 1 / c, logcHead, (double) (logc - logcHead));
+    }
+    fprintf(file, "};\n\n");
+}
+
+/**
+ * Prints table for the exponential function
+ * @param file Output file
+ */
+void printExpTable(FILE *file) {
+    fprintf(file, "static const double fastExpTable[%d] = {\n", FAST_EXP_TABLE_SIZE);
+    for (int i = 0; i < FAST_EXP_TABLE_SIZE; i++) {
+        fprintf(file, "    %a,\n", (double) exp2l((long double) i / FAST_EXP_TABLE_SIZE));
+    }
+    fprintf(file, "};\n\n");
+}
+
+/**
+ * Main program function
+ * @param argc Count of arguments
+ * @param argv Program's arguments
+ * @return Execution status
+ */
+int main(int argc, char *argv[]) {
+    FILE *file = stdout;
+    if (argc == 2 && (file = fopen(argv[1], "w")) == NULL) {
+        perror("genTables");
+        return FILE_WRITE_ERROR;
+    }
+    const long double ln2 = 0.693147180559945309417232121458176568L;
+    long double coefficients[MAX_DEGREE + 1];
+    double tail;
+    fprintf(file, "/* Generated by genTables, do not edit. */\n\n#pragma once\n\n");
+    double head = splitHead(ln2, 32, &tail);
+    fprintf(file, "static const double fastLn2 = %a;\n", head);
+    fprintf(file, "static const double fastLn2Tail = %a;\n", tail);
+    head = splitHead(ln2 / FAST_EXP_TABLE_SIZE, 32, &tail);
+    fprintf(file, "static const double fastLn2N = %a;\n", head);
+    fprintf(file, "static const double fastLn2NTail = %a;\n", tail);
+    fprintf(file, "static const double fastInvLn2N = %a;\n\n", (double) (FAST_EXP_TABLE_SIZE / ln2));
+    chebyshevFit(log1pTail, 1.0L / 128, FAST_LOG_POLY_DEGREE - 2, coefficients);
+    printPolynomial(file, "fastLogPoly", coefficients, 0, FAST_LOG_POLY_DEGREE - 2);
+    chebyshevFit(expm1Tail, ln2 / (2 * FAST_EXP_TABLE_SIZE), FAST_EXP_POLY_DEGREE - 2, coefficients);
+    printPolynomial(file, "fastExpPoly", coefficients, 0, FAST_EXP_POLY_DEGREE - 2);
+    printLogTable(file);
+    printExpTable(file);
+    if (file != stdout && fclose(file) != 0) {
+        perror("genTables");
+        return FILE_WRITE_ERROR;
+    }
+    return NO_ERROR;
+}
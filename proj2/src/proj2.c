@@ -21,180 +21,45 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-/**
- * Exit codes
- */
-enum exitStatuses {
-    NO_ERROR,
-    CONVERSION_ERROR,
-};
-
-/**
- * Converts string into double
- * @param string String to convert
- * @param number Converted double
- * @return Execution status
- */
-int strToDouble(char *string, double *number) {
-    char *endptr;
-    *number = strtod(string, &endptr);
-    if (*endptr != '\0') {
-        fprintf(stderr, "Error in string conversion to double.\n");
-        return CONVERSION_ERROR;
-    }
-    return NO_ERROR;
-}
-
-/**
- * Converts string into unsigned integer
- * @param string String to convert
- * @param number Converted unsigned integer
- * @return Execution status
- */
-int strToUInt(char *string, unsigned int *number) {
-    char *endptr;
-    *number = (unsigned int) strtoul(string, &endptr, 10);
-    if (*endptr != '\0') {
-        fprintf(stderr, "Error in string conversion to unsigned int.\n");
-        return CONVERSION_ERROR;
-    }
-    return NO_ERROR;
-}
-
-/**
- * Calculates the value of the power function of Y with a base X
- * @param f Function for natural logarithm calculation
- * @param x Base of power function
- * @param y Value whose power function is calculated
- * @param n Count of iterations
- * @return Value of the power function of Y with a base X
- */
-double calcExp(double (*f)(double, unsigned int), double x, double y, unsigned int n) {
-    if (x == 0) {
-        if (y == -INFINITY) {
-            return INFINITY;
-        } else if (y == 0) {
-            return NAN;
-        }
-        return 0;
-    }
-    if (y == -INFINITY) {
-        return 0;
-    } else if (y == 0) {
-        return 1;
-    } else if (y == INFINITY) {
-        return INFINITY;
-    }
-    double fraction = 1;
-    double sum = fraction;
-    for (unsigned int i = 1; i < n; i++) {
-        fraction *= ((*f)(fabs(x), n) * y) / i;
-        sum += fraction;
-    }
-    return sum;
-}
+#include "batch.h"
+#include "convert.h"
+#include "fastmath.h"
+#include "proj2.h"
+#include "series.h"
+#include "table.h"
 
 /**
- * Check if value is valid for natural logarithm calculation
- * @param x Value whose logarithm is calculated
- * @return Value whose logarithm is calculated
- */
-double checkLog(double x) {
-    if (x < 0) {
-        return NAN;
-    }
-    if (x == 0) {
-        return -INFINITY;
-    }
-    if (x == INFINITY) {
-        return INFINITY;
-    }
-    return x;
-}
-
-/**
- * Calculates the natural logarithm via a continued fraction
- * @param x Value whose logarithm is calculated
- * @param n Count of iterations
- * @return Natural logarithm
- */
-double cfrac_log(double x, unsigned int n) {
-    double i = checkLog(x);
-    if (isnan(i) || isinf(i)) {
-        return i;
-    }
-    double cf = 0;
-    double a, b;
-    double z = (x - 1) / (x + 1);
-    for (--n; n >= 1; n--) {
-        a = (2 * n) + 1;
-        b = n * z;
-        b *= b;
-        cf = b / (a - cf);
-    }
-    return ((2 * z) / (1 - cf));
-}
-
-/**
- * Calculates the natural logarithm via a Taylor series
+ * Prints calculated the natural logarithm
  * @param x Value whose logarithm is calculated
  * @param n Count of iterations
- * @return Natural logarithm
+ * @param fast Print also the natural logarithm from the table-driven engine
+ * @return Execution status
  */
-double taylor_log(double x, unsigned int n) {
-    double z = checkLog(x);
-    if (isnan(z) || isinf(z)) {
-        return z;
-    }
-    double numerator = 1;
-    double sum = 0;
-    if (x < 1) {
-        for (unsigned int i = 1; i <= n; i++) {
-            numerator *= (1 - x);
-            sum -= numerator / i;
-        }
-    } else {
-        for (unsigned int i = 1; i <= n; i++) {
-            numerator *= (x - 1) / x;
-            sum += numerator / i;
-        }
+int printLog(double x, unsigned int n, bool fast) {
+    printf("       log(%g) = %.12g\n", x, log(x));
+    printf(" cfrac_log(%g) = %.12g\n", x, cfrac_log(x, n));
+    printf("taylor_log(%g) = %.12g\n", x, taylor_log(x, n));
+    if (fast) {
+        printf("  fast_log(%g) = %.12g\n", x, fast_log(x));
     }
-    return sum;
-}
-
-/**
- * Calculates the value of the power function of Y with a base X
- * @param x Base of power function
- * @param y Value whose power function is calculated
- * @param n Count of iterations
- * @return Value of the power function of Y with a base X
- */
-double taylor_pow(double x, double y, unsigned int n) {
-    return calcExp(taylor_log, x, y, n);
-}
-
-/**
- * Calculates the value of the power function of Y with a base X
- * @param x Base of power function
- * @param y Value whose power function is calculated
- * @param n Count of iterations
- * @return Value of the power function of Y with a base X
- */
-double taylorcf_pow(double x, double y, unsigned int n) {
-    return calcExp(cfrac_log, x, y, n);
+    return NO_ERROR;
 }
 
 /**
- * Prints calculated the natural logarithm
+ * Prints the natural logarithm calculated to the requested tolerance
  * @param x Value whose logarithm is calculated
- * @param n Count of iterations
+ * @param eps Relative tolerance of successive convergents
+ * @param maxN Maximal count of iterations
  * @return Execution status
  */
-int printLog(double x, unsigned int n) {
-    printf("       log(%g) = %.12g\n", x, log(x));
-    printf(" cfrac_log(%g) = %.12g\n", x, cfrac_log(x, n));
-    printf("taylor_log(%g) = %.12g\n", x, taylor_log(x, n));
+int printLogTolerance(double x, double eps, unsigned int maxN) {
+    unsigned int n;
+    double result = cfrac_log_eps(x, eps, maxN, &n);
+    printf("          log(%g) = %.12g\n", x, log(x));
+    printf("cfrac_log_eps(%g) = %.12g\n", x, result);
+    printf("       iterations = %u\n", n);
     return NO_ERROR;
 }
 
@@ -203,12 +68,16 @@ int printLog(double x, unsigned int n) {
  * @param x Base
  * @param y Value whose power function is calculated
  * @param n Count of iterations
+ * @param fast Print also the value from the table-driven engine
  * @return Execution status
  */
-int printPow(double x, double y, unsigned int n) {
+int printPow(double x, double y, unsigned int n, bool fast) {
     printf("         pow(%g,%g) = %.12g\n", x, y, pow(x, y));
     printf("  taylor_pow(%g,%g) = %.12g\n", x, y, taylor_pow(x, y, n));
     printf("taylorcf_pow(%g,%g) = %.12g\n", x, y, taylorcf_pow(x, y, n));
+    if (fast) {
+        printf("    fast_pow(%g,%g) = %.12g\n", x, y, fast_pow(x, y));
+    }
     return NO_ERROR;
 }
 
@@ -217,10 +86,15 @@ int printPow(double x, double y, unsigned int n) {
  * @return Execution status
  */
 int printUsage() {
-    puts("Usage: ./proj2 [options] [arguments]");
+    puts("Usage: ./proj2 [-f] [-b] [options] [arguments]");
     puts("Options:");
+    puts("\t-f, --fast\t\tPrints also results of the table-driven engine");
+    puts("\t-b, --binary\t\tPrints --table values as native doubles");
     puts("\t--log X N\t\tCalculates the natural logarithm of X with N iterations");
+    puts("\t--log-eps X EPS N\tCalculates the natural logarithm of X to the relative tolerance EPS with at most N iterations");
     puts("\t--pow X Y N\t\tCalculates the value of the power function of Y with a base X with N iterations");
+    puts("\t--table A B STEP N [Y]\tTabulates the natural logarithm (or the power function of Y) from A to B");
+    puts("\t--batch [T]\t\tEvaluates queries \"FUNCTION X [Y] [N]\" from stdin with T threads (default all cores)");
     puts("\t-h, --help\t\tPrints help (this message) and exits");
     return NO_ERROR;
 }
@@ -234,15 +108,48 @@ int printUsage() {
 int main(int argc, char *argv[]) {
     double x, y;
     unsigned int n;
+    bool fast = false;
+    bool binary = false;
+    while (argc > 1) {
+        if ((strcmp(argv[1], "--fast") == 0) || (strcmp(argv[1], "-f") == 0)) {
+            fast = true;
+        } else if ((strcmp(argv[1], "--binary") == 0) || (strcmp(argv[1], "-b") == 0)) {
+            binary = true;
+        } else {
+            break;
+        }
+        argc--;
+        argv++;
+    }
     if (argc == 4 && (strcmp(argv[1], "--log") == 0)) {
         strToDouble(argv[2], &x);
         strToUInt(argv[3], &n);
-        return printLog(x, n);
+        return printLog(x, n, fast);
+    } else if (argc == 5 && (strcmp(argv[1], "--log-eps") == 0)) {
+        double eps;
+        if (strToDouble(argv[2], &x) || strToDouble(argv[3], &eps) || strToUInt(argv[4], &n)) {
+            return CONVERSION_ERROR;
+        }
+        return printLogTolerance(x, eps, n);
     } else if (argc == 5 && (strcmp(argv[1], "--pow") == 0)) {
         strToDouble(argv[2], &x);
         strToDouble(argv[3], &y);
         strToUInt(argv[4], &n);
-        return printPow(x, y, n);
+        return printPow(x, y, n, fast);
+    } else if ((argc == 6 || argc == 7) && (strcmp(argv[1], "--table") == 0)) {
+        double a, b, step;
+        y = 0;
+        if (strToDouble(argv[2], &a) || strToDouble(argv[3], &b) || strToDouble(argv[4], &step) ||
+            strToUInt(argv[5], &n) || (argc == 7 && strToDouble(argv[6], &y))) {
+            return CONVERSION_ERROR;
+        }
+        return printTable(a, b, step, n, argc == 7, y, binary);
+    } else if ((argc == 2 || argc == 3) && (strcmp(argv[1], "--batch") == 0)) {
+        unsigned int threads = 0;
+        if (argc == 3 && strToUInt(argv[2], &threads) != NO_ERROR) {
+            return CONVERSION_ERROR;
+        }
+        return batchEvaluate(STDIN_FILENO, STDOUT_FILENO, threads, BATCH_CHUNK_SIZE);
     }
     return printUsage();
 }
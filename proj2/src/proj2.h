@@ -0,0 +1,14 @@
+#pragma once
+
+/**
+ * Exit codes
+ */
+enum exitStatuses {
+    NO_ERROR,
+    CONVERSION_ERROR,
+    READ_ERROR,
+    WRITE_ERROR,
+    ALLOCATION_ERROR,
+    THREAD_ERROR,
+    ARGUMENT_ERROR,
+};
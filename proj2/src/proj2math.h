@@ -0,0 +1,100 @@
+/*
+ * Embeddable front end of the natural logarithm and power function engines.
+ *
+ * All functions are inline and take the method as a compile-time constant, so
+ * the compiler resolves the method and (for N = 8, 16 or 32) the unrolled
+ * evaluator statically and inlines the whole evaluation into the caller:
+ *
+ *     double y = proj2Log(PROJ2_CFRAC, x, 16);
+ *     proj2PowBatch(PROJ2_FAST, xs, ys, results, count, 0);
+ *
+ * The same engines are available as ordinary functions from the proj2math
+ * library (series.h and fastmath.h).
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include "fastmathImpl.h"
+#include "seriesImpl.h"
+
+/**
+ * Evaluation methods
+ */
+enum proj2Methods {
+    /// Taylor series (taylor_log and taylor_pow)
+    PROJ2_TAYLOR,
+    /// Continued fraction (cfrac_log and taylorcf_pow)
+    PROJ2_CFRAC,
+    /// Table-driven engine (fast_log and fast_pow), the count of iterations is ignored
+    PROJ2_FAST,
+};
+
+/**
+ * Calculates the natural logarithm
+ * @param method Evaluation method
+ * @param x Value whose logarithm is calculated
+ * @param n Count of iterations
+ * @return Natural logarithm
+ */
+static inline double proj2Log(enum proj2Methods method, double x, unsigned int n) {
+    switch (method) {
+        case PROJ2_TAYLOR:
+            return seriesTaylorLog(x, n);
+        case PROJ2_CFRAC:
+            return seriesCfracLog(x, n);
+        default:
+            return fastLog(x);
+    }
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param method Evaluation method
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param n Count of iterations
+ * @return Value of the power function of Y with a base X
+ */
+static inline double proj2Pow(enum proj2Methods method, double x, double y, unsigned int n) {
+    switch (method) {
+        case PROJ2_TAYLOR:
+            return seriesTaylorPow(x, y, n);
+        case PROJ2_CFRAC:
+            return seriesTaylorCfPow(x, y, n);
+        default:
+            return fastPow(x, y);
+    }
+}
+
+/**
+ * Calculates natural logarithms of all values of the span
+ * @param method Evaluation method
+ * @param x Values whose logarithms are calculated
+ * @param result Natural logarithms, may be the same span as X
+ * @param count Count of values
+ * @param n Count of iterations
+ */
+static inline void proj2LogBatch(enum proj2Methods method, const double *x, double *result, size_t count,
+                                 unsigned int n) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = proj2Log(method, x[i], n);
+    }
+}
+
+/**
+ * Calculates values of the power function for all pairs of the spans
+ * @param method Evaluation method
+ * @param x Bases of power function
+ * @param y Values whose power functions are calculated
+ * @param result Values of the power function, may be the same span as X or Y
+ * @param count Count of values
+ * @param n Count of iterations
+ */
+static inline void proj2PowBatch(enum proj2Methods method, const double *x, const double *y, double *result,
+                                 size_t count, unsigned int n) {
+    for (size_t i = 0; i < count; i++) {
+        result[i] = proj2Pow(method, x[i], y[i], n);
+    }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "series.h"
+#include "seriesImpl.h"
+
+/// Defines the evaluators specialized for N iterations
+#define DEFINE_SPECIALIZED(N) \
+    double cfrac_log_##N(double x) { \
+        return seriesCfracLog##N(x); \
+    } \
+    double taylor_log_##N(double x) { \
+        return seriesTaylorLog##N(x); \
+    } \
+    double taylor_pow_##N(double x, double y) { \
+        return seriesTaylorPow##N(x, y); \
+    } \
+    double taylorcf_pow_##N(double x, double y) { \
+        return seriesTaylorCfPow##N(x, y); \
+    }
+
+DEFINE_SPECIALIZED(8)
+DEFINE_SPECIALIZED(16)
+DEFINE_SPECIALIZED(32)
+
+/**
+ * Check if values are special cases of the power function
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param result Value of the power function for special cases
+ * @return Is it a special case?
+ */
+bool checkPow(double x, double y, double *result) {
+    return seriesCheckPow(x, y, result);
+}
+
+/**
+ * Check if value is valid for natural logarithm calculation
+ * @param x Value whose logarithm is calculated
+ * @return Value whose logarithm is calculated
+ */
+double checkLog(double x) {
+    return seriesCheckLog(x);
+}
+
+/**
+ * Calculates the exponential function via a Taylor series
+ * @param t Value whose exponential function is calculated
+ * @param n Count of iterations
+ * @return Exponential function
+ */
+double calcExp(double t, unsigned int n) {
+    return seriesExp(t, n);
+}
+
+/**
+ * Calculates the natural logarithm via a continued fraction
+ * @param x Value whose logarithm is calculated
+ * @param n Count of iterations
+ * @return Natural logarithm
+ */
+double cfrac_log(double x, unsigned int n) {
+    return seriesCfracLog(x, n);
+}
+
+/**
+ * Calculates the natural logarithm via a continued fraction evaluated forward
+ * until successive convergents agree to the requested tolerance
+ * @param x Value whose logarithm is calculated
+ * @param eps Relative tolerance of successive convergents
+ * @param maxN Maximal count of iterations
+ * @param n Count of iterations used, may be NULL
+ * @return Natural logarithm
+ */
+double cfrac_log_eps(double x, double eps, unsigned int maxN, unsigned int *n) {
+    return seriesCfracLogTolerance(x, eps, maxN, n);
+}
+
+/**
+ * Calculates the convergents of the continued fraction of the natural
+ * logarithm in one forward pass
+ * @param x Value whose logarithm is calculated
+ * @param convergents Natural logarithms with 1, 2, ..., COUNT iterations
+ * @param count Count of convergents
+ */
+void cfrac_log_convergents(double x, double *convergents, unsigned int count) {
+    seriesCfracLogConvergents(x, convergents, count);
+}
+
+/**
+ * Calculates the natural logarithm via a Taylor series
+ * @param x Value whose logarithm is calculated
+ * @param n Count of iterations
+ * @return Natural logarithm
+ */
+double taylor_log(double x, unsigned int n) {
+    return seriesTaylorLog(x, n);
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param n Count of iterations
+ * @return Value of the power function of Y with a base X
+ */
+double taylor_pow(double x, double y, unsigned int n) {
+    return seriesTaylorPow(x, y, n);
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param n Count of iterations
+ * @return Value of the power function of Y with a base X
+ */
+double taylorcf_pow(double x, double y, unsigned int n) {
+    return seriesTaylorCfPow(x, y, n);
+}
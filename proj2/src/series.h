@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+
+/// Count of terms of the reduced exponential series reaching the double precision
+#define EXP_MAX_TERMS 16
+
+bool checkPow(double x, double y, double *result);
+
+double checkLog(double x);
+
+double calcExp(double t, unsigned int n);
+
+double cfrac_log(double x, unsigned int n);
+
+double cfrac_log_eps(double x, double eps, unsigned int maxN, unsigned int *n);
+
+void cfrac_log_convergents(double x, double *convergents, unsigned int count);
+
+double taylor_log(double x, unsigned int n);
+
+double taylor_pow(double x, double y, unsigned int n);
+
+double taylorcf_pow(double x, double y, unsigned int n);
+
+double cfrac_log_8(double x);
+
+double cfrac_log_16(double x);
+
+double cfrac_log_32(double x);
+
+double taylor_log_8(double x);
+
+double taylor_log_16(double x);
+
+double taylor_log_32(double x);
+
+double taylor_pow_8(double x, double y);
+
+double taylor_pow_16(double x, double y);
+
+double taylor_pow_32(double x, double y);
+
+double taylorcf_pow_8(double x, double y);
+
+double taylorcf_pow_16(double x, double y);
+
+double taylorcf_pow_32(double x, double y);
@@ -0,0 +1,413 @@
+/*
+ * Natural logarithm and power function series. The evaluators are inline, so
+ * they can be embedded via proj2math.h, series.c provides them as the
+ * functions declared in series.h.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "series.h"
+
+/// Natural logarithm of 2, the head has trailing zero bits so k * SERIES_LN2_HEAD is exact
+#define SERIES_LN2_HEAD 0x1.62e42feep-1
+/// Natural logarithm of 2, the tail
+#define SERIES_LN2_TAIL 0x1.a39ef35793c76p-33
+/// Binary logarithm of e
+#define SERIES_LOG2_E 0x1.71547652b82fep0
+/// Exponent beyond which the exponential function surely overflows or underflows
+#define SERIES_EXP_LIMIT 1e4
+/// Replacement of zero denominators in the forward evaluation of continued fractions
+#define SERIES_LENTZ_TINY 0x1p-1000
+
+/*
+ * Evaluators specialized for the fixed count of iterations. The loops are
+ * unrolled by the preprocessor and the evaluators perform the same operations
+ * in the same order as the generic loops, so their results are identical.
+ */
+
+/// Repeats the statement N times
+#define SERIES_REPEAT_1(step) step
+#define SERIES_REPEAT_7(step) SERIES_REPEAT_1(step) SERIES_REPEAT_1(step) SERIES_REPEAT_1(step) SERIES_REPEAT_1(step) SERIES_REPEAT_1(step) SERIES_REPEAT_1(step) \
+    SERIES_REPEAT_1(step)
+#define SERIES_REPEAT_8(step) SERIES_REPEAT_7(step) SERIES_REPEAT_1(step)
+#define SERIES_REPEAT_15(step) SERIES_REPEAT_8(step) SERIES_REPEAT_7(step)
+#define SERIES_REPEAT_16(step) SERIES_REPEAT_8(step) SERIES_REPEAT_8(step)
+#define SERIES_REPEAT_31(step) SERIES_REPEAT_16(step) SERIES_REPEAT_15(step)
+#define SERIES_REPEAT_32(step) SERIES_REPEAT_16(step) SERIES_REPEAT_16(step)
+
+/// Defines the exponential function with N terms of a Taylor series (M = N - 1)
+#define SERIES_DEFINE_EXP(N, M) \
+    static inline double seriesExpTerms##N(double r) { \
+        double fraction = 1; \
+        double sum = fraction; \
+        double i = 1; \
+        SERIES_REPEAT_##M({ fraction *= r / i; sum += fraction; i++; }) \
+        return sum; \
+    } \
+    static inline double seriesExp##N(double t) { \
+        int k; \
+        double r; \
+        if (seriesReduceExp(t, &k, &r)) { \
+            return r; \
+        } \
+        return ldexp(seriesExpTerms##N(r), k); \
+    }
+
+/// Defines the natural logarithm via a continued fraction with N levels (M = N - 1)
+#define SERIES_DEFINE_CFRAC_LOG(N, M) \
+    static inline double seriesCfracLog##N(double x) { \
+        double i = seriesCheckLog(x); \
+        if (isnan(i) || isinf(i)) { \
+            return i; \
+        } \
+        double cf = 0; \
+        double z = (x - 1) / (x + 1); \
+        double k = M; \
+        SERIES_REPEAT_##M({ double b = k * z; b *= b; cf = b / ((2 * k + 1) - cf); k--; }) \
+        return ((2 * z) / (1 - cf)); \
+    }
+
+/// Defines the natural logarithm via a Taylor series with N terms
+#define SERIES_DEFINE_TAYLOR_LOG(N) \
+    static inline double seriesTaylorLog##N(double x) { \
+        double z = seriesCheckLog(x); \
+        if (isnan(z) || isinf(z)) { \
+            return z; \
+        } \
+        double numerator = 1; \
+        double sum = 0; \
+        double i = 1; \
+        if (x < 1) { \
+            double q = 1 - x; \
+            SERIES_REPEAT_##N({ numerator *= q; sum -= numerator / i; i++; }) \
+        } else { \
+            double q = (x - 1) / x; \
+            SERIES_REPEAT_##N({ numerator *= q; sum += numerator / i; i++; }) \
+        } \
+        return sum; \
+    }
+
+/// Defines the power functions with N iterations (E is min(N, EXP_MAX_TERMS))
+#define SERIES_DEFINE_POW(N, E) \
+    static inline double seriesTaylorPow##N(double x, double y) { \
+        double result; \
+        if (seriesCheckPow(x, y, &result)) { \
+            return result; \
+        } \
+        return seriesExp##E(seriesTaylorLog##N(fabs(x)) * y); \
+    } \
+    static inline double seriesTaylorCfPow##N(double x, double y) { \
+        double result; \
+        if (seriesCheckPow(x, y, &result)) { \
+            return result; \
+        } \
+        return seriesExp##E(seriesCfracLog##N(fabs(x)) * y); \
+    }
+
+/**
+ * Check if values are special cases of the power function
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param result Value of the power function for special cases
+ * @return Is it a special case?
+ */
+static inline bool seriesCheckPow(double x, double y, double *result) {
+    if (x == 0) {
+        if (y == -INFINITY) {
+            *result = INFINITY;
+        } else if (y == 0) {
+            *result = NAN;
+        } else {
+            *result = 0;
+        }
+        return true;
+    }
+    if (y == -INFINITY) {
+        *result = 0;
+    } else if (y == 0) {
+        *result = 1;
+    } else if (y == INFINITY) {
+        *result = INFINITY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reduces the exponent to t = k * ln(2) + r, where |r| <= ln(2) / 2
+ * @param t Exponent
+ * @param k Power of two
+ * @param r Reduced exponent or the exponential function if it is out of range
+ * @return Is the exponential function out of range?
+ */
+static inline bool seriesReduceExp(double t, int *k, double *r) {
+    if (!(fabs(t) < SERIES_EXP_LIMIT)) {
+        *r = isnan(t) ? t : ((t > 0) ? INFINITY : 0);
+        return true;
+    }
+    double kd = round(t * SERIES_LOG2_E);
+    *k = (int) kd;
+    *r = (t - kd * SERIES_LN2_HEAD) - kd * SERIES_LN2_TAIL;
+    return false;
+}
+
+/**
+ * Check if value is valid for natural logarithm calculation
+ * @param x Value whose logarithm is calculated
+ * @return Value whose logarithm is calculated
+ */
+static inline double seriesCheckLog(double x) {
+    if (x < 0) {
+        return NAN;
+    }
+    if (x == 0) {
+        return -INFINITY;
+    }
+    if (x == INFINITY) {
+        return INFINITY;
+    }
+    return x;
+}
+
+SERIES_DEFINE_EXP(8, 7)
+SERIES_DEFINE_EXP(16, 15)
+SERIES_DEFINE_CFRAC_LOG(8, 7)
+SERIES_DEFINE_CFRAC_LOG(16, 15)
+SERIES_DEFINE_CFRAC_LOG(32, 31)
+SERIES_DEFINE_TAYLOR_LOG(8)
+SERIES_DEFINE_TAYLOR_LOG(16)
+SERIES_DEFINE_TAYLOR_LOG(32)
+SERIES_DEFINE_POW(8, 8)
+SERIES_DEFINE_POW(16, 16)
+SERIES_DEFINE_POW(32, 16)
+
+/**
+ * Calculates the exponential function via a Taylor series
+ * The series is evaluated only for the reduced exponent r = t - k * ln(2),
+ * |r| <= ln(2) / 2, and the result is scaled by 2^k. The series for r
+ * converges to the double precision within EXP_MAX_TERMS terms, so more terms
+ * are never evaluated.
+ * @param t Value whose exponential function is calculated
+ * @param n Count of iterations
+ * @return Exponential function
+ */
+static inline double seriesExp(double t, unsigned int n) {
+    if (n >= EXP_MAX_TERMS) {
+        return seriesExp16(t);
+    } else if (n == 8) {
+        return seriesExp8(t);
+    }
+    int k;
+    double r;
+    if (seriesReduceExp(t, &k, &r)) {
+        return r;
+    }
+    double fraction = 1;
+    double sum = fraction;
+    for (unsigned int i = 1; i < n; i++) {
+        fraction *= r / i;
+        sum += fraction;
+    }
+    return ldexp(sum, k);
+}
+
+/**
+ * Calculates the natural logarithm via a continued fraction
+ * @param x Value whose logarithm is calculated
+ * @param n Count of iterations
+ * @return Natural logarithm
+ */
+static inline double seriesCfracLog(double x, unsigned int n) {
+    switch (n) {
+        case 8:
+            return seriesCfracLog8(x);
+        case 16:
+            return seriesCfracLog16(x);
+        case 32:
+            return seriesCfracLog32(x);
+        default:
+            break;
+    }
+    double i = seriesCheckLog(x);
+    if (isnan(i) || isinf(i)) {
+        return i;
+    }
+    double cf = 0;
+    double a, b;
+    double z = (x - 1) / (x + 1);
+    for (--n; n >= 1; n--) {
+        a = (2 * n) + 1;
+        b = n * z;
+        b *= b;
+        cf = b / (a - cf);
+    }
+    return ((2 * z) / (1 - cf));
+}
+
+/*
+ * Forward evaluation of the continued fraction by the modified Lentz method.
+ * The logarithm is ln(x) = 2z / g, where z = (x - 1) / (x + 1) and
+ *
+ *     g = 1 - z^2 / (3 - 4z^2 / (5 - 9z^2 / (7 - ...))).
+ *
+ * The k-th step turns the (k - 1)-th convergent of g into the k-th one, so
+ * the k-th convergent of the logarithm equals the result of cfrac_log with
+ * k + 1 iterations up to rounding.
+ */
+
+/**
+ * Advances the forward evaluation of the continued fraction g by one level
+ * @param z2 Square of z = (x - 1) / (x + 1)
+ * @param k Level of the continued fraction, starting with 1
+ * @param c Ratio of successive numerators
+ * @param d Ratio of successive denominators
+ * @return Ratio of the new and the previous convergent of g
+ */
+static inline double seriesLentzStep(double z2, unsigned int k, double *c, double *d) {
+    double a = -((double) k * k) * z2;
+    double b = 2.0 * k + 1;
+    *d = b + a * *d;
+    if (*d == 0) {
+        *d = SERIES_LENTZ_TINY;
+    }
+    *c = b + a / *c;
+    if (*c == 0) {
+        *c = SERIES_LENTZ_TINY;
+    }
+    *d = 1 / *d;
+    return *c * *d;
+}
+
+/**
+ * Calculates the natural logarithm via a continued fraction evaluated forward
+ * until successive convergents agree to the requested tolerance
+ * @param x Value whose logarithm is calculated
+ * @param eps Relative tolerance of successive convergents
+ * @param maxN Maximal count of iterations
+ * @param n Count of iterations used, may be NULL
+ * @return Natural logarithm
+ */
+static inline double seriesCfracLogTolerance(double x, double eps, unsigned int maxN, unsigned int *n) {
+    unsigned int used = 0;
+    double result = seriesCheckLog(x);
+    if (!isnan(result) && !isinf(result)) {
+        double z = (x - 1) / (x + 1);
+        double z2 = z * z;
+        double g = 1;
+        double c = g;
+        double d = 0;
+        for (used = 1; used < maxN; used++) {
+            double delta = seriesLentzStep(z2, used, &c, &d);
+            g *= delta;
+            if (fabs(delta - 1) <= eps) {
+                used++;
+                break;
+            }
+        }
+        result = (2 * z) / g;
+    }
+    if (n != NULL) {
+        *n = used;
+    }
+    return result;
+}
+
+/**
+ * Calculates the convergents of the continued fraction of the natural
+ * logarithm in one forward pass
+ * @param x Value whose logarithm is calculated
+ * @param convergents Natural logarithms with 1, 2, ..., COUNT iterations
+ * @param count Count of convergents
+ */
+static inline void seriesCfracLogConvergents(double x, double *convergents, unsigned int count) {
+    double result = seriesCheckLog(x);
+    if (isnan(result) || isinf(result)) {
+        for (unsigned int i = 0; i < count; i++) {
+            convergents[i] = result;
+        }
+        return;
+    }
+    double z = (x - 1) / (x + 1);
+    double z2 = z * z;
+    double g = 1;
+    double c = g;
+    double d = 0;
+    for (unsigned int i = 0; i < count; i++) {
+        if (i > 0) {
+            g *= seriesLentzStep(z2, i, &c, &d);
+        }
+        convergents[i] = (2 * z) / g;
+    }
+}
+
+/**
+ * Calculates the natural logarithm via a Taylor series
+ * @param x Value whose logarithm is calculated
+ * @param n Count of iterations
+ * @return Natural logarithm
+ */
+static inline double seriesTaylorLog(double x, unsigned int n) {
+    switch (n) {
+        case 8:
+            return seriesTaylorLog8(x);
+        case 16:
+            return seriesTaylorLog16(x);
+        case 32:
+            return seriesTaylorLog32(x);
+        default:
+            break;
+    }
+    double z = seriesCheckLog(x);
+    if (isnan(z) || isinf(z)) {
+        return z;
+    }
+    double numerator = 1;
+    double sum = 0;
+    if (x < 1) {
+        for (unsigned int i = 1; i <= n; i++) {
+            numerator *= (1 - x);
+            sum -= numerator / i;
+        }
+    } else {
+        for (unsigned int i = 1; i <= n; i++) {
+            numerator *= (x - 1) / x;
+            sum += numerator / i;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param n Count of iterations
+ * @return Value of the power function of Y with a base X
+ */
+static inline double seriesTaylorPow(double x, double y, unsigned int n) {
+    double result;
+    if (seriesCheckPow(x, y, &result)) {
+        return result;
+    }
+    return seriesExp(seriesTaylorLog(fabs(x), n) * y, n);
+}
+
+/**
+ * Calculates the value of the power function of Y with a base X
+ * @param x Base of power function
+ * @param y Value whose power function is calculated
+ * @param n Count of iterations
+ * @return Value of the power function of Y with a base X
+ */
+static inline double seriesTaylorCfPow(double x, double y, unsigned int n) {
+    double result;
+    if (seriesCheckPow(x, y, &result)) {
+        return result;
+    }
+    return seriesExp(seriesCfracLog(fabs(x), n) * y, n);
+}
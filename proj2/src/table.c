@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2018  Roman Ondráček <xondra58@stud.fit.vutbr.cz>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+/*
+ * Incremental tabulation of the natural logarithm and the power function over
+ * a grid. Only anchor points are evaluated from scratch via the continued
+ * fraction with N iterations, the neighbouring points are corrected by
+ *
+ *     ln(x) = ln(a) + 2 * atanh(z),  z = (x - a) / (x + a),
+ *     x^y = a^y * exp(y * 2 * atanh(z)),
+ *
+ * where a is the last anchor. The series in z converges fast, because a new
+ * anchor is taken as soon as |z| exceeds TABLE_Z_LIMIT. Every point is
+ * corrected from the anchor directly, so errors do not accumulate.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "proj2.h"
+#include "seriesImpl.h"
+#include "table.h"
+
+/// Largest ratio z = (x - a) / (x + a) corrected from the anchor
+#define TABLE_Z_LIMIT 0x1p-6
+/// Maximal count of terms of the correction series
+#define TABLE_MAX_TERMS 64
+/// Size of the output buffer
+#define TABLE_BUFFER_SIZE (1 << 16)
+/// Maximal length of one output line
+#define TABLE_LINE_SIZE 64
+
+/**
+ * Calculates 2 * atanh(z) = ln((1 + z) / (1 - z)) for small z
+ * @param z Ratio (x - a) / (x + a)
+ * @return Natural logarithm of x / a
+ */
+static inline double logRatio(double z) {
+    double z2 = z * z;
+    double power = z;
+    double sum = z;
+    for (unsigned int k = 3; k < 2 * TABLE_MAX_TERMS; k += 2) {
+        power *= z2;
+        double term = power / k;
+        sum += term;
+        if (fabs(term) <= 0x1p-54 * fabs(sum)) {
+            break;
+        }
+    }
+    return 2 * sum;
+}
+
+/**
+ * Calculates exp(u) for small u
+ * @param u Exponent
+ * @return Exponential function
+ */
+static inline double expSmall(double u) {
+    double term = 1;
+    double sum = 1;
+    for (unsigned int k = 1; k < TABLE_MAX_TERMS; k++) {
+        term *= u / k;
+        sum += term;
+        if (fabs(term) <= 0x1p-54 * fabs(sum)) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * Flushes the output buffer into stdout
+ * @param buffer Output buffer
+ * @param length Length of the buffered output
+ * @return Execution status
+ */
+static int flushTable(const char *buffer, size_t *length) {
+    if (fwrite(buffer, 1, *length, stdout) != *length) {
+        perror("proj2");
+        return WRITE_ERROR;
+    }
+    *length = 0;
+    return NO_ERROR;
+}
+
+/**
+ * Prints the natural logarithm (or the power function) of all grid points
+ * @param a First point of the grid
+ * @param b Last point of the grid
+ * @param step Distance of the grid points
+ * @param n Count of iterations of the anchor evaluations
+ * @param power Tabulate the power function instead of the natural logarithm
+ * @param y Exponent of the power function
+ * @param binary Print values as native doubles instead of "X VALUE" lines
+ * @return Execution status
+ */
+int printTable(double a, double b, double step, unsigned int n, bool power, double y, bool binary) {
+    if (!(step > 0) || !(b >= a) || isinf(b - a)) {
+        fprintf(stderr, "Invalid grid, expected A <= B and STEP > 0.\n");
+        return CONVERSION_ERROR;
+    }
+    static char buffer[TABLE_BUFFER_SIZE];
+    size_t length = 0;
+    double zLimit = TABLE_Z_LIMIT;
+    if (power && fabs(y) > 1) {
+        zLimit /= fabs(y);
+    }
+    double anchor = NAN;
+    double anchorLog = NAN;
+    double anchorPow = NAN;
+    double last = floor((b - a) / step + 1e-9);
+    for (double i = 0; i <= last; i++) {
+        double x = a + i * step;
+        double z = (x - anchor) / (x + anchor);
+        double value;
+        if (x > 0 && anchor > 0 && fabs(z) <= zLimit) {
+            double logarithm = logRatio(z);
+            value = power ? anchorPow * expSmall(y * logarithm) : anchorLog + logarithm;
+        } else {
+            anchor = x;
+            anchorLog = seriesCfracLog(x, n);
+            if (power) {
+                anchorPow = seriesTaylorCfPow(x, y, n);
+            }
+            value = power ? anchorPow : anchorLog;
+        }
+        if (TABLE_BUFFER_SIZE - length < TABLE_LINE_SIZE && flushTable(buffer, &length) != NO_ERROR) {
+            return WRITE_ERROR;
+        }
+        if (binary) {
+            memcpy(buffer + length, &value, sizeof(value));
+            length += sizeof(value);
+        } else {
+            length += snprintf(buffer + length, TABLE_LINE_SIZE, "%.12g %.12g\n", x, value);
+        }
+    }
+    return flushTable(buffer, &length);
+}
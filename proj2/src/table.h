@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdbool.h>
+
+int printTable(double a, double b, double step, unsigned int n, bool power, double y, bool binary);